@@ -8,6 +8,8 @@
 #include <sys/inotify.h>
 #include <libnotify/notify.h>
 #include <unistd.h>
+#include <limits.h>
+#include <pthread.h>
 
 
 #define EXT_SUCCESS 0
@@ -18,10 +20,33 @@
 #define EXT_ERR_READ_INOTIFY 5
 #define EXT_ERR_LIBNOTIFY 6
 
+#define NOTIFY_WINDOW_MS 1000 // 이벤트를 모아서 알림 하나로 보여 주는 주기
+#define PENDING_NAME_SLOTS 1024 // 종류별로 이번 주기에 기억하는 파일 이름 해시 수 (2의 거듭제곱)
+#define PENDING_NAME_LIMIT (PENDING_NAME_SLOTS * 3 / 4) // 이만큼 모이면 더 세지 않고 "N+ files"로 표시
+
+// 알림에 모으는 이벤트 종류
+enum
+{
+    KIND_CREATED,
+    KIND_DELETED,
+    KIND_ACCESSED,
+    KIND_WRITTEN,
+    KIND_MODIFIED,
+    KIND_MOVED,
+    KIND_COUNT
+};
+
+const char *KindNames[KIND_COUNT] = { "created", "deleted", "accessed", "written and closed", "modified", "moved" };
+
 int IeventStatus =-1;
 int IeventQueue =-1;
 char *ProgramTitle = "wifi_daemon";
 
+pthread_mutex_t PendingLock = PTHREAD_MUTEX_INITIALIZER; // 아래 집계 보호
+unsigned PendingCounts[KIND_COUNT];   // 이번 주기에 종류별로 이벤트가 난 서로 다른 파일 수
+uint32_t PendingNames[KIND_COUNT][PENDING_NAME_SLOTS]; // 종류별로 이미 센 파일 이름 해시 (0은 빈 슬롯)
+char PendingName[NAME_MAX + 1];       // 마지막 이벤트의 파일 이름 (이벤트가 하나뿐이면 이름으로 알림)
+
 void signal_handler(int signal)
 {
     int closeStatus = -1;
@@ -39,16 +64,124 @@ void signal_handler(int signal)
 }
 
 
+// 파일 이름 해시 (FNV-1a, 0은 빈 슬롯 표시라 쓰지 않음)
+uint32_t hash_name(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    for(const unsigned char *c = (const unsigned char *)name; *c; ++c)
+    {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash ? hash : 1;
+}
+
+// 읽기 루프에서 호출: 이벤트를 집계만 하고 알림은 알림 스레드가 보냄
+// 같은 파일에 같은 종류의 이벤트가 여러 번 나도 한 번만 셈 (반복해서 쓰는 파일 하나가 "4000 files"가 되지 않도록)
+void add_pending_event(int kind, const char *name)
+{
+    uint32_t hash = hash_name(name);
+    pthread_mutex_lock(&PendingLock);
+    if(PendingCounts[kind] < PENDING_NAME_LIMIT)
+    {
+        uint32_t *slots = PendingNames[kind];
+        uint32_t slot = hash & (PENDING_NAME_SLOTS - 1);
+        while(slots[slot] != 0 && slots[slot] != hash)
+            slot = (slot + 1) & (PENDING_NAME_SLOTS - 1);
+        if(slots[slot] == 0)
+        {
+            slots[slot] = hash;
+            PendingCounts[kind]++;
+        }
+    }
+    snprintf(PendingName, sizeof(PendingName), "%s", name);
+    pthread_mutex_unlock(&PendingLock);
+}
+
+// 모인 이벤트를 "37 files modified, 2 files created in build/" 형태로 요약 (이벤트가 없으면 0)
+int build_summary(const unsigned counts[KIND_COUNT], const char *name, const char *basePath, char *summary, size_t size)
+{
+    unsigned total = 0;
+    int kinds = 0;
+    int last = 0;
+    for(int kind = 0; kind < KIND_COUNT; ++kind)
+    {
+        total += counts[kind];
+        if(counts[kind] > 0)
+        {
+            kinds++;
+            last = kind;
+        }
+    }
+    if(total == 0)
+        return 0;
+
+    if(total == 1)
+        return snprintf(summary, size, "File %s %s in %s/", name, KindNames[last], basePath);
+
+    size_t length = 0;
+    for(int kind = 0; kind < KIND_COUNT && length < size; ++kind)
+    {
+        if(counts[kind] == 0)
+            continue;
+        length += snprintf(summary + length, size - length, "%u%s %s %s%s", counts[kind],
+                           counts[kind] >= PENDING_NAME_LIMIT ? "+" : "", counts[kind] == 1 ? "file" : "files",
+                           KindNames[kind], --kinds > 0 ? ", " : "");
+    }
+    if(length < size)
+        length += snprintf(summary + length, size - length, " in %s/", basePath);
+    return (int)length;
+}
+
+// 알림 스레드: 주기마다 모인 이벤트를 요약해서 하나의 알림을 제자리에서 갱신
+void *notify_thread(void *arg)
+{
+    const char *basePath = arg;
+    NotifyNotification *notifyHandle = notify_notification_new(basePath, "", "dialog-information");
+    if(notifyHandle == NULL)
+    {
+        fprintf(stderr, "notifyHandle was NULL\n");
+        return NULL;
+    }
+
+    while(true)
+    {
+        usleep(NOTIFY_WINDOW_MS * 1000);
+
+        unsigned counts[KIND_COUNT];
+        char name[NAME_MAX + 1];
+        pthread_mutex_lock(&PendingLock);
+        memcpy(counts, PendingCounts, sizeof(counts));
+        for(int kind = 0; kind < KIND_COUNT; ++kind)
+        {
+            if(PendingCounts[kind] > 0)
+                memset(PendingNames[kind], 0, sizeof(PendingNames[kind]));
+        }
+        memset(PendingCounts, 0, sizeof(PendingCounts));
+        memcpy(name, PendingName, sizeof(name));
+        pthread_mutex_unlock(&PendingLock);
+
+        char summary[512];
+        if(build_summary(counts, name, basePath, summary, sizeof(summary)) == 0)
+            continue;
+
+        printf("%s\n", summary);
+        notify_notification_update(notifyHandle, basePath, summary, "dialog-information");
+        if(!notify_notification_show(notifyHandle, NULL))
+            fprintf(stderr, "Error showing notification\n");
+    }
+}
+
 int main(int argc, char** argv)
 {  
     bool libnotifyInitStatus = false;
     char *basePath = NULL;
     char *token = NULL;
-    char buffer[4096];
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
     int readLength;
     const struct inotify_event *watchEvent;
-    char *notificationMessage = NULL;
-    NotifyNotification *notifyHandle;
+    int kind;
+    pthread_t notifyThread;
 
 
     const uint32_t watchMask = IN_CREATE | IN_DELETE | IN_ACCESS | IN_CLOSE_WRITE | IN_MODIFY | IN_MOVE_SELF;
@@ -98,6 +231,12 @@ int main(int argc, char** argv)
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
 
+    if(pthread_create(&notifyThread, NULL, notify_thread, basePath) != 0)
+    {
+        fprintf(stderr, "Error starting notification thread\n");
+        exit(EXT_ERR_LIBNOTIFY);
+    }
+
     while(true)
     {
         printf("waiting for ievent...\n");
@@ -110,49 +249,33 @@ int main(int argc, char** argv)
         for(char *buffPointer= buffer; buffPointer < buffer + readLength; )//buffPointer+=sizeof(struct inotify_event) + watchEvent->len)
         {
             watchEvent = (const struct inotify_event*) buffPointer;
-            printf("Processing event: mask=%u, len=%u\n", watchEvent->mask, watchEvent->len);
 
-            notificationMessage = NULL;
+            kind = -1;
 
             if(watchEvent->mask & IN_CREATE)
-                notificationMessage = "File created\n";
+                kind = KIND_CREATED;
 
             else if(watchEvent->mask & IN_DELETE)
-                notificationMessage = "File deleted\n";
+                kind = KIND_DELETED;
 
             else if(watchEvent->mask & IN_ACCESS)
-                notificationMessage = "File accessed\n";
+                kind = KIND_ACCESSED;
 
             else if(watchEvent->mask & IN_CLOSE_WRITE )
-                notificationMessage = "File written and closed\n";
+                kind = KIND_WRITTEN;
 
             else if(watchEvent->mask & IN_MODIFY)
-                notificationMessage = "File modified\n";
+                kind = KIND_MODIFIED;
 
             else if(watchEvent->mask & IN_MOVE_SELF)
-                notificationMessage = "File moved\n";
+                kind = KIND_MOVED;
             
 
-            if(notificationMessage != NULL)
-            {
-
-                printf("%s\n", notificationMessage);
-
-                notifyHandle = notify_notification_new(basePath, notificationMessage, "dialog-information");
-                if(notifyHandle == NULL)
-                {
-                    fprintf(stderr, "notifyHandle was NULL");
-                    continue;
-                }
-           
-                else notify_notification_show(notifyHandle, NULL);
-            }
+            // 알림은 알림 스레드가 모아서 보내므로 읽기 루프는 기다리지 않음
+            if(kind != -1)
+                add_pending_event(kind, watchEvent->len > 0 ? watchEvent->name : basePath);
             
             buffPointer+=sizeof(struct inotify_event) + watchEvent->len;
-            printf("Advancing pointer by %lu bytes\n", sizeof(struct inotify_event) + watchEvent->len);///
-            
-            usleep(10000);
-
         }
                     
 
@@ -0,0 +1,73 @@
+// file_monitor 공유 메모리 이벤트 링 형식과 읽기 라이브러리 (event_ring_client.c)
+//
+// file_monitor가 event_ring_name (shm_open 이름)으로 링을 만들고 이벤트마다 슬롯 하나를 씀
+// 읽는 쪽은 읽기 전용으로 mmap하고 시스템 콜 없이 각자의 커서로 읽음 (쓰는 쪽은 읽는 쪽을 기다리지 않음)
+// 레코드 번호 s는 슬롯 s % slotCount에 쓰이며, 너무 늦은 읽기는 덮어쓰인 만큼 건너뜀 (lapped)
+#ifndef FILE_MONITOR_EVENT_RING_H
+#define FILE_MONITOR_EVENT_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EVENT_RING_MAGIC 0x474e5246u          // "FRNG"
+#define EVENT_RING_VERSION 1
+#define EVENT_RING_SLOT_SIZE 512              // 슬롯 크기 (고정)
+#define EVENT_RING_PATH_SPACE (EVENT_RING_SLOT_SIZE - 32) // 슬롯 안의 경로 공간
+#define EVENT_RING_TRUNCATED 0x1              // 경로가 길어서 잘림 (flags)
+
+// 링 헤더 (쓰는 쪽이 바꾸는 값은 따로 캐시 라인에 둠)
+typedef struct {
+    uint32_t magic;                   // EVENT_RING_MAGIC
+    uint32_t version;                 // EVENT_RING_VERSION
+    uint32_t slotSize;                // EVENT_RING_SLOT_SIZE
+    uint32_t slotCount;               // 슬롯 수 (2의 거듭제곱)
+    uint64_t firstSequence;           // 이 링에 처음 쓴 레코드 번호
+    uint32_t writerPid;               // 링을 만든 file_monitor 프로세스
+    uint32_t closed;                  // file_monitor가 종료했으면 1
+    char reserved[32];
+    uint64_t writeSequence;           // 마지막으로 다 쓴 레코드 번호 (0이면 아직 없음)
+    char padding[56];
+} EventRingHeader;
+
+// 슬롯: sequence를 0으로 바꾼 뒤 내용을 쓰고, 마지막에 레코드 번호를 씀
+// 읽는 쪽은 복사 전후의 sequence가 같을 때만 내용을 믿음
+typedef struct {
+    uint64_t sequence;                // 레코드 번호 (쓰는 중이면 0)
+    int64_t timeNs;                   // 이벤트 발생 시각 (CLOCK_REALTIME, 나노초)
+    uint32_t mask;                    // inotify 이벤트 마스크
+    uint32_t count;                   // 병합된 원본 이벤트 수
+    uint16_t pathLength;              // 경로 길이 (NUL 제외)
+    uint16_t oldPathOffset;           // path 안의 이전 경로 위치 (0이면 없음)
+    uint16_t flags;                   // EVENT_RING_TRUNCATED
+    uint16_t reserved;
+    char path[EVENT_RING_PATH_SPACE]; // NUL로 끝나는 경로 (이름 변경이면 이전 경로가 이어서 옴)
+} EventRingSlot;
+
+// event_ring_read 반환 값
+#define EVENT_RING_EVENT 1                    // 이벤트 하나를 읽음
+#define EVENT_RING_EMPTY 0                    // 새 이벤트 없음
+#define EVENT_RING_LAPPED 2                   // 너무 늦어서 lapped개의 이벤트를 건너뜀
+#define EVENT_RING_CLOSED 3                   // file_monitor가 종료했고 남은 이벤트도 없음
+
+// 읽는 쪽 상태 (읽는 쪽마다 하나)
+typedef struct {
+    const EventRingHeader* header;
+    const EventRingSlot* slots;
+    size_t mapSize;
+    uint64_t cursor;                  // 다음에 읽을 레코드 번호
+    uint64_t lapped;                  // 마지막 EVENT_RING_LAPPED에서 건너뛴 이벤트 수
+    uint64_t lost;                    // 지금까지 건너뛴 이벤트 수
+} EventRingReader;
+
+// 링 열기 (fromOldest가 0이면 지금 이후의 이벤트부터 읽음, 실패 시 -1)
+int event_ring_open(EventRingReader* reader, const char* name, int fromOldest);
+
+// 다음 이벤트를 event로 복사 (EVENT_RING_* 반환)
+int event_ring_read(EventRingReader* reader, EventRingSlot* event);
+
+// 이전 경로 (없으면 NULL)
+const char* event_ring_old_path(const EventRingSlot* event);
+
+void event_ring_close(EventRingReader* reader);
+
+#endif
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "event_ring.h"
+
+// 아직 덮어쓰이지 않은 가장 오래된 레코드 번호
+static uint64_t oldest_sequence(const EventRingHeader* header, uint64_t written) {
+    uint64_t oldest = written >= header->slotCount ? written - header->slotCount + 1 : 1;
+    return oldest > header->firstSequence ? oldest : header->firstSequence;
+}
+
+int event_ring_open(EventRingReader* reader, const char* name, int fromOldest) {
+    memset(reader, 0, sizeof(*reader));
+
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd == -1) {
+        perror(name);
+        return -1;
+    }
+
+    struct stat ringStat;
+    if (fstat(fd, &ringStat) == -1 || ringStat.st_size < (off_t)sizeof(EventRingHeader)) {
+        fprintf(stderr, "Invalid event ring %s\n", name);
+        close(fd);
+        return -1;
+    }
+    reader->mapSize = (size_t)ringStat.st_size;
+    void* map = mmap(NULL, reader->mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        perror(name);
+        return -1;
+    }
+
+    reader->header = map;
+    reader->slots = (const EventRingSlot*)((const char*)map + sizeof(EventRingHeader));
+    const EventRingHeader* header = reader->header;
+    if (header->magic != EVENT_RING_MAGIC || header->version != EVENT_RING_VERSION ||
+        header->slotSize != sizeof(EventRingSlot) || header->slotCount == 0 ||
+        sizeof(EventRingHeader) + (size_t)header->slotCount * sizeof(EventRingSlot) > reader->mapSize) {
+        fprintf(stderr, "Incompatible event ring %s\n", name);
+        event_ring_close(reader);
+        return -1;
+    }
+
+    uint64_t written = __atomic_load_n(&header->writeSequence, __ATOMIC_ACQUIRE);
+    reader->cursor = written + 1;
+    if (fromOldest) reader->cursor = oldest_sequence(header, written);
+    return 0;
+}
+
+int event_ring_read(EventRingReader* reader, EventRingSlot* event) {
+    const EventRingHeader* header = reader->header;
+    uint64_t written = __atomic_load_n(&header->writeSequence, __ATOMIC_ACQUIRE);
+    if (reader->cursor > written) {
+        return __atomic_load_n(&header->closed, __ATOMIC_ACQUIRE) ? EVENT_RING_CLOSED : EVENT_RING_EMPTY;
+    }
+
+    // 쓰는 쪽이 이미 한 바퀴 앞서 있으면 남아 있는 가장 오래된 레코드로 이동
+    uint64_t oldest = oldest_sequence(header, written);
+    for (;;) {
+        if (reader->cursor < oldest) {
+            reader->lapped = oldest - reader->cursor;
+            reader->lost += reader->lapped;
+            reader->cursor = oldest;
+            return EVENT_RING_LAPPED;
+        }
+
+        const EventRingSlot* slot = &reader->slots[reader->cursor & (header->slotCount - 1)];
+        uint64_t before = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        if (before == reader->cursor) {
+            memcpy(event, slot, sizeof(*event));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->sequence, __ATOMIC_RELAXED) == reader->cursor) {
+                event->path[sizeof(event->path) - 1] = '\0';
+                reader->cursor++;
+                return EVENT_RING_EVENT;
+            }
+        }
+
+        // 읽는 동안 덮어쓰였음: 쓰는 쪽 위치를 다시 읽고 건너뜀
+        written = __atomic_load_n(&header->writeSequence, __ATOMIC_ACQUIRE);
+        oldest = oldest_sequence(header, written);
+        if (reader->cursor >= oldest) oldest = reader->cursor + 1;
+    }
+}
+
+const char* event_ring_old_path(const EventRingSlot* event) {
+    if (event->oldPathOffset == 0 || event->oldPathOffset >= sizeof(event->path)) return NULL;
+    return event->path + event->oldPathOffset;
+}
+
+void event_ring_close(EventRingReader* reader) {
+    if (reader->header) munmap((void*)reader->header, reader->mapSize);
+    reader->header = NULL;
+    reader->slots = NULL;
+}
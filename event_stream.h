@@ -0,0 +1,40 @@
+// file_monitor 구독 소켓 프레임 형식
+//
+// 클라이언트는 subscribe_socket에 연결한 뒤 탭으로 구분한 요청 줄을 보냄
+//   SUBSCRIBE<TAB>루트 경로[<TAB>이벤트 종류[<TAB>이름 접미사]]\n   (연결마다 한 번)
+//   이벤트 종류: create,delete,modify,move 중 쉼표로 구분 (생략하거나 all이면 전체)
+//   CHANGES<TAB>커서 토큰[<TAB>루트 경로]\n
+//   커서 이후 바뀐 경로를 경로마다 한 번씩 EVENT_FRAME_CHANGE로 보내고 EVENT_FRAME_CURSOR로 끝냄
+//   커서 토큰은 "실행 구분값:순서 번호" 형태이며 EVENT_FRAME_CURSOR/RESET의 path로 받음
+//   (실행 구분값은 EVENT_FRAME_SUBSCRIBED의 timeNs와 같으므로 이벤트의 sequence로 직접 만들 수도 있음)
+// 그 뒤로 서버는 EventFrame을 이어서 보냄 (정수는 호스트 바이트 순서)
+#ifndef FILE_MONITOR_EVENT_STREAM_H
+#define FILE_MONITOR_EVENT_STREAM_H
+
+#include <stdint.h>
+
+#define EVENT_STREAM_VERSION 1
+
+#define EVENT_FRAME_SUBSCRIBED 1              // 구독 수락 (sequence는 현재 순서 번호, timeNs는 실행 구분값, count는 EVENT_STREAM_VERSION)
+#define EVENT_FRAME_EVENT 2                   // 이벤트 하나
+#define EVENT_FRAME_DROPPED 3                 // 버퍼가 가득 차서 count개의 이벤트를 버림
+#define EVENT_FRAME_ERROR 4                   // 잘못된 요청 (path에 설명, 보낸 뒤 연결을 닫음)
+#define EVENT_FRAME_CHANGE 5                  // CHANGES 응답: 바뀐 경로 (sequence와 mask는 마지막 변경)
+#define EVENT_FRAME_CURSOR 6                  // CHANGES 응답 끝 (path는 다음 커서 토큰, count는 보낸 경로 수)
+#define EVENT_FRAME_RESET 7                   // 커서가 다른 실행의 것이거나 너무 오래됨 (path는 현재 커서 토큰)
+
+#define EVENT_CURSOR_MORE 0x1                 // EVENT_FRAME_CURSOR의 mask: 버퍼가 모자라 남은 변경이 있음
+
+// 프레임 헤더 뒤에 NUL로 끝나는 경로가 오고, 이름 변경이면 이전 경로가 이어서 옴
+typedef struct {
+    uint32_t length;                  // 헤더를 포함한 프레임 전체 크기
+    uint16_t type;                    // EVENT_FRAME_*
+    uint16_t oldPathOffset;           // path 안의 이전 경로 위치 (0이면 없음)
+    uint64_t sequence;                // 이벤트 순서 번호 (빠진 번호로 유실을 알 수 있음)
+    int64_t timeNs;                   // 이벤트 발생 시각 (CLOCK_REALTIME, 나노초)
+    uint32_t mask;                    // inotify 이벤트 마스크
+    uint32_t count;                   // 병합된 원본 이벤트 수 (EVENT_FRAME_DROPPED이면 버린 이벤트 수)
+    char path[];
+} EventFrame;
+
+#endif
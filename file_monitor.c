@@ -1,3 +1,4 @@
+#define _GNU_SOURCE // open_by_handle_at, O_PATH
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -16,6 +17,24 @@
 #include <glib.h>
 #include <limits.h>
 #include <canberra.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#include <sys/uio.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <zlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include "journal.h"
+#include "event_stream.h"
+#include "event_ring.h"
 
 #define EXT_SUCCESS 0                // 성공 코드
 #define EXT_ERR_TOO_FEW_ARGS 1       // 인자 부족 오류 코드
@@ -23,517 +42,5097 @@
 #define EXT_ERR_ADD_WATCH 3          // 디렉토리 감시 추가 실패 오류 코드
 #define EXT_ERR_READ_INOTIFY 5       // inotify 이벤트 읽기 오류 코드
 #define EXT_ERR_CONFIG_FILE 6        // 설정 파일 읽기 오류 코드
+#define EXT_ERR_EVENT_LOOP 7         // epoll 이벤트 루프 초기화 실패 오류 코드
+
+#define INOTIFY_READ_BUFFER_SIZE (256 * 1024) // inotify 읽기 버퍼 크기 (read 한 번에 수천 개 이벤트)
+#define INOTIFY_READ_BUFFER_ALIGN 4096        // 읽기 버퍼 정렬 단위 (페이지)
+#define INOTIFY_MAX_READS_PER_WAKEUP 64       // 한 번 깨어났을 때 최대 read 횟수 (종료 요청 확인을 위해 제한)
+#define EPOLL_MAX_EVENTS 8                    // epoll_wait 한 번에 받을 최대 이벤트 수
+
+#define EVENT_PATH_MAX 1024                   // 이벤트 레코드에 담을 수 있는 최대 경로 길이
+#define EVENT_TIMESTAMP_LENGTH 23             // "YYYY-MM-DD HH:MM:SS.mmm" 길이
+#define UI_RING_CAPACITY 4096                 // UI 이벤트 링 버퍼 크기 (2의 거듭제곱)
+#define UI_FRAME_INTERVAL_MS 33               // UI 갱신 최소 간격 (약 30 Hz)
+#define DIRECTORY_COLUMN_NAME 0               // 디렉토리 목록 열: 이름 (루트는 전체 경로)
+#define DIRECTORY_COLUMN_WD 1                 // 디렉토리 목록 열: watch descriptor (-1이면 펼치기 전 자리 표시 행)
+#define DIRECTORY_COLUMN_BACKGROUND 2         // 디렉토리 목록 열: 강조 배경색 (NULL이면 강조 없음)
+#define DIRECTORY_HIGHLIGHT_COLOR "#ffcccc"   // 활동이 있었던 디렉토리 배경색
+#define CONTENTS_CHUNK_ENTRIES 2048           // 디렉토리 내용 목록을 UI로 넘기는 묶음 크기
+#define CONTENTS_MAX_CHUNKS_IN_FLIGHT 4       // UI가 아직 처리하지 않은 묶음이 이만큼 쌓이면 목록 작성 스레드가 기다림
+#define LOG_RING_CAPACITY 16384               // 로그 기록 스레드 이벤트 링 크기 (2의 거듭제곱)
+#define LOG_WRITE_CHUNK_SIZE (64 * 1024)      // 로그 기록 버퍼 조각 크기
+#define LOG_WRITE_CHUNKS 16                   // writev 한 번에 모으는 최대 버퍼 조각 수 (그룹 커밋 단위)
+#define SUBSCRIBER_MAX 64                     // 동시에 연결할 수 있는 구독자 수
+#define SUBSCRIBER_REQUEST_MAX (PATH_MAX + 256) // 구독 요청 줄 최대 길이
+#define SUBSCRIBER_REPLY_RESERVE ((sizeof(EventFrame) + SUBSCRIBER_REQUEST_MAX + 7) & ~(size_t)7) // 요청 줄 하나에 답하는 데 필요한 버퍼 공간
+#define SUBSCRIBER_BUFFER_MIN_KB 16           // 구독자 전송 버퍼 최소 크기 (답할 공간보다 커야 함)
+#define JOURNAL_WRITE_BATCH 2048              // 저널 레코드를 모아서 쓰는 단위
+#define JOURNAL_STRING_SLOTS_INITIAL 4096     // 저널 경로 중복 제거 표 초기 크기 (2의 거듭제곱)
+#define LOG_IDLE_TIMEOUT_MS 1000              // 기록할 이벤트가 없을 때 기록 스레드가 잠드는 최대 시간
+#define LOG_COMPRESS_BUFFER_SIZE (256 * 1024) // 로그 조각 압축 시 읽기 버퍼 크기
+#define LOG_TIMESTAMP_LENGTH 19               // 로그 줄의 "YYYY-MM-DD HH:MM:SS" 길이
+#define CACHE_LINE_SIZE 64                    // 생산자/소비자 인덱스 분리용 캐시 라인 크기
+
+#define WATCH_INDEX_INITIAL_CAPACITY 1024      // watch 인덱스 초기 크기 (2의 거듭제곱)
+#define WATCH_NODE_INITIAL_CAPACITY 1024      // 감시 노드 배열 초기 크기
+#define WATCH_NODE_NONE UINT32_MAX            // 노드 없음 (루트의 부모)
+#define WATCH_NODE_DEAD 0x1                   // 삭제된 디렉토리 (병합 대기 이벤트가 끝나면 해제)
+#define WATCH_NODE_RESCAN_QUEUED 0x2          // 이번 오버플로 재검사 큐에 이미 들어간 디렉토리
+#define WATCH_NODE_CRAWL_PENDING 0x4          // 초기 탐색이 아직 항목을 읽지 않은 디렉토리 (재검사 제외)
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_DELETE_SELF) // 디렉토리 감시 마스크
+#define NAME_CHUNK_SHIFT 16                   // 이름 ID에서 청크 번호 위치
+#define NAME_CHUNK_SIZE (1 << NAME_CHUNK_SHIFT) // 이름 풀 청크 크기 (64 KB)
+#define NAME_NONE UINT32_MAX                  // 이름 없음
+#define WATCH_INDEX_EMPTY -1                  // 비어 있는 인덱스 슬롯
+#define WATCH_INDEX_DELETED -2                // 삭제된 인덱스 슬롯 (탐색은 계속)
+
+#define CRAWL_MAX_THREADS 16                  // 초기 탐색 최대 스레드 수
+#define CRAWL_MAX_OPEN_FDS 512                // 탐색 대기 중에 열어 둘 최대 디렉토리 fd 수 (넘으면 경로로 다시 염)
+#define CRAWL_DENTS_BUFFER_SIZE (64 * 1024)   // getdents64 버퍼 크기
+#define CRAWL_DEQUE_INITIAL_CAPACITY 256      // 스레드별 작업 덱 초기 크기 (2의 거듭제곱)
+#define CRAWL_SLICE_MS 20                     // 초기 탐색 시간 조각 (조각 사이에 감시 스레드가 이벤트 처리)
+#define CRAWL_PROGRESS_INTERVAL_MS 500        // 초기 탐색 진행 표시 갱신 주기
+
+#define MOVE_PAIR_WINDOW_MS 100              // IN_MOVED_FROM 뒤에 짝이 되는 IN_MOVED_TO를 기다리는 시간
+#define MOVE_PAIR_MAX 1024                    // 동시에 짝을 기다리는 최대 이동 이벤트 수
+
+#define RESCAN_BATCH_DIRS 256                 // 오버플로 재검사에서 이벤트 루프 한 번에 처리할 디렉토리 수
+#define RECENT_ACTIVITY_MAX 4096              // 재검사 우선순위를 위해 기억하는 최근 이벤트 디렉토리 수
+#define ENTRY_SET_INITIAL_CAPACITY 8          // 디렉토리 항목 집합 초기 크기 (2의 거듭제곱)
+
+#define FANOTIFY_HANDLE_CACHE_SIZE 8192       // 파일 핸들 -> 디렉토리 캐시 슬롯 수 (2의 거듭제곱)
+#define FANOTIFY_HANDLE_MAX 64                // 캐시에 저장할 수 있는 최대 파일 핸들 크기
+#define FANOTIFY_WATCH_MASK (FAN_CREATE | FAN_DELETE | FAN_MODIFY | FAN_RENAME | FAN_ONDIR) // 파일 시스템 표시 마스크
+#define FANOTIFY_LEGACY_MOVE_MASK (FAN_MOVED_FROM | FAN_MOVED_TO) // FAN_RENAME이 없는 커널(5.17 이전)용 이동 이벤트
+
+#define COALESCE_BUCKETS 4096                 // 병합 대기 이벤트 해시 버킷 수 (2의 거듭제곱)
+#define COALESCE_MAX_PENDING 16384            // 동시에 병합 대기할 수 있는 최대 (wd, name) 개수
 
 // 전역 변수들
 int IeventQueue = -1;                // inotify 대기 큐 (이벤트를 기다리는 큐)
+int FanotifyFd = -1;                 // fanotify 그룹 (fanotify 백엔드일 때만 사용)
+bool useFanotify = false;            // 디렉토리별 inotify 감시 대신 파일 시스템 전체를 fanotify로 감시 (설정에서 읽음)
+int EpollFd = -1;                    // 이벤트 루프 epoll 인스턴스
+int WakeupFd = -1;                   // 이벤트 루프 깨우기/종료 알림용 eventfd
+int SignalFd = -1;                   // 종료 시그널 수신용 signalfd (헤드리스 모드에서만 사용)
+bool headless = false;               // GTK/사운드 없이 감시만 함 (설정 또는 --headless, 구독 소켓/이벤트 링으로 이벤트를 받음)
+volatile sig_atomic_t monitorRunning = 1; // 이벤트 루프 실행 여부
+int watcherExitCode = EXT_SUCCESS;   // 감시 스레드 종료 코드
 char* ProgramTitle = "file_monitor"; // 프로그램 제목
-time_t lastEventTime = 0;            // 마지막 이벤트 발생 시간
-FILE* logFile = NULL;                // 로그 파일 포인터
+int coalesceWindowMs = 500;          // 같은 파일의 이벤트를 하나로 병합하는 시간 창 (설정에서 읽음)
+int crawlThreads = 0;                // 초기 탐색 스레드 수 (설정에서 읽음, 0이면 CPU 수)
+bool overflowRescan = true;          // 큐 오버플로 시 재검사를 위해 디렉토리 항목을 기억할지 여부 (설정에서 읽음)
+int LogFd = -1;                      // 로그 파일 (기록 스레드만 씀)
+int logSyncIntervalMs = 1000;        // fdatasync 주기 (설정에서 읽음, 0이면 묶음마다, 음수이면 하지 않음)
+bool echoEvents = false;             // 로그 줄을 표준 출력에도 씀 (설정에서 읽음, 기록 스레드가 씀)
+char subscribeSocketPath[108] = "";  // 구독 소켓 경로 (설정에서 읽음, 비어 있으면 사용하지 않음)
+int subscriberBufferKb = 256;        // 구독자별 전송 버퍼 크기 (설정에서 읽음)
+bool subscriberDisconnectOnFull = false; // 버퍼가 가득 차면 버리는 대신 연결을 끊음 (설정에서 읽음)
+char eventRingName[256] = "";        // 공유 메모리 이벤트 링 이름 (설정에서 읽음, 비어 있으면 사용하지 않음)
+int eventRingSlots = 16384;          // 이벤트 링 슬롯 수 (설정에서 읽음, 2의 거듭제곱으로 올림)
+int changeIndexMaxPaths = 65536;     // 변경 색인에 남길 경로 수 (설정에서 읽음)
+int logViewCapacity = 10000;         // 로그 창에 남길 이벤트 줄 수 (설정에서 읽음)
+int soundIntervalMs = 250;           // 이벤트 사운드 최소 간격 (설정에서 읽음, 그 사이 요청은 한 번으로 합침)
+char journalFilePath[512] = "";      // 바이너리 저널 경로 (설정에서 읽음, 비어 있으면 사용하지 않음)
+int logRotateSizeMb = 64;            // 로그 파일이 이 크기를 넘으면 교체 (설정에서 읽음, 0이면 크기로 교체하지 않음)
+int logRotateHours = 24;             // 로그 파일을 이 시간마다 교체 (설정에서 읽음, 0이면 시간으로 교체하지 않음)
+int logKeepSegments = 0;             // 보관할 압축 로그 조각 수 (설정에서 읽음, 0이면 모두 보관)
 char logFilePath[512];               // 로그 파일 경로 (설정에서 읽음)
 char filteredExtension[64] = "";     // 필터링할 확장자 (설정에서 읽음)
 
 // gtk variables
 GtkWidget *logWindow;
-GtkWidget *logTextView;
-GtkTextBuffer *logBuffer;
-GtkWidget *directoryListBox;
-GtkWidget *directoryContentsBox;
-GtkWidget *selectedDirectoryBox = NULL;
+GtkWidget *logTreeView;
+GtkListStore *logStore;              // 로그 창 행 (최대 logViewCapacity개, 오래된 행부터 지움)
+GtkAdjustment *logScrollAdjustment;
+int logStoreRows = 0;                // logStore의 현재 행 수
+GtkWidget *directoryTreeView;
+GtkTreeStore *directoryStore;        // 펼친 디렉토리의 행만 만듦 (접으면 하위 행을 지움)
+GHashTable *directoryRows;           // wd -> 목록 행 GtkTreeIter (GTK 스레드만 사용)
+GtkWidget *contentsTreeView;
+GtkListStore *contentsStore;         // 디렉토리 내용 행 (디렉토리 이름은 '/'로 끝남)
+GtkWidget *directoryHeader;          // 디렉토리 목록 제목 (초기 탐색 중에는 진행 상황 표시)
+GtkWidget *contentsHeader;
+char *contentsDirectory = NULL;      // 지금 내용 창에 보여 주는 디렉토리 (GTK 스레드만 사용)
+int contentsRows = 0;
+bool contentsLoading = false;        // 목록 작성이 진행 중인지 여부 (GTK 스레드만 사용)
+uint64_t contentsGeneration = 0;     // 내용 목록 요청 번호 (바뀌면 진행 중인 목록 작성은 취소)
+int contentsChunksInFlight = 0;      // UI에 넘겼지만 아직 처리되지 않은 묶음 수
+pthread_mutex_t contentsFlowLock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t contentsFlowReady = PTHREAD_COND_INITIALIZER; // UI가 묶음을 처리했거나 요청 번호가 바뀜
 
 
-// 디렉토리와 watch descriptor (wd)의 매핑 테이블
+// 디렉토리 안의 파일 이름 ID 집합 (마지막으로 알고 있는 상태, 오버플로 재검사 비교용)
 typedef struct {
-    int wd;                           // watch descriptor
-    char path[512];                   // 디렉토리 경로
-
-    GtkWidget *eventBox;
-} WatchDescriptor;
+    uint32_t* slots;                  // 선형 탐사 슬롯 (NAME_NONE이면 비어 있음)
+    uint32_t count;                   // 저장된 이름 수
+    uint32_t capacity;                // 슬롯 개수 (2의 거듭제곱, 0이면 미할당)
+} EntrySet;
 
-WatchDescriptor watchDescriptors[512];  // watch descriptor 배열
-int watchDescriptorCount = 0;           // 등록된 watch descriptor의 개수
+// 감시 중인 디렉토리 노드 (전체 경로 대신 부모 노드와 이름만 저장하고 필요할 때 경로를 조립)
+typedef struct {
+    int wd;                           // watch descriptor
+    uint32_t parent;                  // 부모 디렉토리 노드 (루트이면 WATCH_NODE_NONE)
+    uint32_t name;                    // 디렉토리 이름의 이름 풀 ID (루트는 설정에 적힌 전체 경로, 빈 노드는 NAME_NONE)
+    uint32_t flags;                   // WATCH_NODE_DEAD 등
+    uint32_t firstChild;              // 첫 번째 하위 디렉토리 노드
+    uint32_t nextSibling;             // 같은 부모 아래의 다음 노드
+    uint32_t prevSibling;             // 같은 부모 아래의 이전 노드
+    EntrySet entries;                 // 디렉토리 안의 파일 (하위 디렉토리는 자식 노드)
 
-void event_sound() {
-    ca_context *context = NULL;
+    uint8_t listed;                   // 디렉토리 목록에 행이 있는지 여부 (GTK 스레드가 잠금을 잡고 변경)
+    uint8_t highlightPending;         // 다음 UI 프레임의 강조 목록에 이미 들어 있는지 여부
+} WatchNode;
 
-    // libcanberra 컨텍스트 초기화
-    if (ca_context_create(&context) < 0) {
-        fprintf(stderr, "Failed to create sound context\n");
-        return;
-    }
+// 다음 UI 프레임에서 강조할 디렉토리
+typedef struct {
+    uint32_t node;
+    int wd;                           // 그 사이 노드가 재사용되었는지 확인용
+} HighlightRequest;
 
-    // 간단한 이벤트 사운드 재생 (기본 사운드 테마)
-    ca_context_play(context, 0,
-                    CA_PROP_EVENT_ID, "message-new-instant",
-                    CA_PROP_EVENT_DESCRIPTION, "File event notification",
-                    NULL);
+// 삭제되어 해제를 기다리는 노드
+typedef struct {
+    uint32_t node;
+    int64_t releaseMs;                // 이 시각 이후 해제 (monotonic)
+} RetiredWatch;
 
-    // 컨텍스트 해제
-    ca_context_destroy(context);
-}
+// 감시 테이블은 감시 스레드만 변경하며, 다른 스레드는 watchTableLock을 잡고 읽음
+pthread_mutex_t watchTableLock = PTHREAD_MUTEX_INITIALIZER;
+WatchNode* watchNodes = NULL;           // 감시 노드 배열 (필요할 때 두 배로 확장)
+uint32_t watchNodeCount = 0;            // 사용한 노드 슬롯 개수 (빈 슬롯 포함)
+uint32_t watchNodeCapacity = 0;         // 할당된 노드 개수
+uint32_t watchNodeFreeList = WATCH_NODE_NONE; // 재사용 가능한 노드 (parent 필드로 연결)
+RetiredWatch* retiredWatches = NULL;    // 해제 대기 노드 큐
+size_t retiredHead = 0;                 // 큐에서 다음으로 해제할 위치
+size_t retiredCount = 0;                // 큐에 들어 있는 항목 끝 위치
+size_t retiredCapacity = 0;             // 큐 할당 크기
 
-void init_css() {
-    const char *css = 
-        ".selected { background-color: #d1ecf1; border: 1px solid #0c5460; }"
-        ".highlighted { background-color: #ffcccc; border: 1px solid #cc0000; }";
-    GtkCssProvider *provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider, css, -1, NULL);
+// 해시 인덱스 슬롯 (key는 해시 값, slot은 노드 위치 또는 이름 ID)
+typedef struct {
+    uint32_t key;
+    int slot;                         // WATCH_INDEX_EMPTY / WATCH_INDEX_DELETED / 노드 위치
+} WatchIndexEntry;
 
-    gtk_style_context_add_provider_for_screen(gdk_screen_get_default(),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_USER);
-    g_object_unref(provider);
-}
+// 선형 탐사 open-addressing 해시 테이블
+typedef struct {
+    WatchIndexEntry* entries;
+    size_t capacity;                  // 슬롯 개수 (2의 거듭제곱)
+    size_t used;                      // 사용 중이거나 삭제 표시된 슬롯 수
+} WatchIndex;
 
-void apply_custom_css(GtkWidget *widget, const char *css) {
-    GtkCssProvider *provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider, css, -1, NULL);
+WatchIndex wdIndex;                     // wd -> 노드 위치
+WatchIndex childIndex;                  // (부모 노드, 이름 ID) -> 노드 위치 (경로 -> wd 역방향 조회용)
+WatchIndex nameIndex;                   // 이름 해시 -> 이름 ID (같은 이름은 한 번만 저장)
 
-    GtkStyleContext *context = gtk_widget_get_style_context(widget);
-    gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider),
-                                   GTK_STYLE_PROVIDER_PRIORITY_USER);
+char** nameChunks = NULL;               // 이름 풀 청크 배열 (arena)
+uint32_t nameChunkCount = 0;            // 사용 중인 청크 수
+uint32_t nameChunkCapacity = 0;         // 할당된 청크 포인터 수
+uint32_t nameChunkUsed = NAME_CHUNK_SIZE; // 마지막 청크에서 사용한 바이트 수
 
-    g_object_unref(provider);
-}
+// 감시 스레드에서 UI 스레드로 전달되는 고정 크기 이벤트 레코드
+typedef struct {
+    uint64_t sequence;                // 이벤트 순서 번호 (log_event에서 붙임)
+    int64_t eventTimeNs;              // 이벤트 발생 시각 (CLOCK_REALTIME, 나노초)
+    uint32_t mask;                    // inotify 이벤트 마스크
+    int wd;                           // 이벤트가 발생한 디렉토리의 watch descriptor
+    uint32_t count;                   // 병합된 원본 이벤트 수
+    uint32_t oldPathOffset;           // 이름 변경 시 path 안에 이어 저장한 이전 경로 위치 (0이면 없음)
+    char path[EVENT_PATH_MAX];        // 파일의 전체 경로 (이름 변경이면 "새 경로\0이전 경로")
+} EventRecord;
 
-void on_directory_clicked(GtkWidget *widget, GdkEventButton *event, gpointer data) {
-    if (event->type == GDK_BUTTON_PRESS && event->button == 1) { // 클릭 감지
-        if (selectedDirectoryBox) {
-            // 이전에 선택된 디렉토리 상자의 스타일 제거
-            GtkStyleContext *prevContext = gtk_widget_get_style_context(selectedDirectoryBox);
-            gtk_style_context_remove_class(prevContext, "selected");
-        }
+// getdents64가 돌려주는 디렉토리 항목
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
 
-        // 새로 선택된 디렉토리 상자에 스타일 추가
-        GtkStyleContext *currentContext = gtk_widget_get_style_context(widget);
-        gtk_style_context_add_class(currentContext, "selected");
+// 탐색할 디렉토리 (감시와 노드 등록은 이미 끝난 상태)
+typedef struct {
+    int fd;                           // 열려 있는 디렉토리 fd (-1이면 노드 경로로 다시 염)
+    uint32_t node;                    // 디렉토리 노드
+    int wd;                           // 등록 시점의 wd (처리 전에 삭제되어 노드가 재사용되었는지 확인)
+} CrawlItem;
 
-        selectedDirectoryBox = widget; // 선택된 디렉토리 상자 업데이트
-    }
-}
+// 스레드별 작업 덱: 소유 스레드는 tail에서 넣고 빼며 (깊이 우선), 다른 스레드는 head에서 훔쳐 감
+typedef struct {
+    pthread_mutex_t lock;
+    CrawlItem* items;                 // 원형 버퍼
+    size_t head;                      // 훔쳐 갈 위치
+    size_t tail;                      // 소유 스레드가 넣을 위치
+    size_t capacity;                  // 슬롯 개수 (2의 거듭제곱)
+} CrawlDeque;
 
-void on_directory_double_click(GtkWidget *widget, GdkEventButton *event, gpointer data) {
-    if (event->type == GDK_2BUTTON_PRESS && event->button == 1) { // 더블 클릭 감지
-        const char *clickedPath = (const char *)data;
+// 디렉토리 트리 탐색 상태
+typedef struct {
+    CrawlDeque* deques;               // 스레드별 작업 덱
+    int workerCount;                  // 탐색 스레드 수
+    bool dynamic;                     // 시작 후 생긴 디렉토리 탐색 (감시 스레드에서 실행)
+    int outstanding;                  // 처리가 끝나지 않은 디렉토리 수 (0이면 탐색 완료)
+    int openFds;                      // 덱에서 대기 중인 열린 fd 수
+    uint64_t directories;             // 감시를 건 디렉토리 수
+    uint64_t entries;                 // 읽은 디렉토리 항목 수
+    int64_t startMs;                  // 탐색 시작 시각 (monotonic)
+    pthread_mutex_t workLock;
+    pthread_cond_t workAvailable;     // 덱에 작업이 들어왔거나 모든 디렉토리 처리 완료 (CLOCK_MONOTONIC)
 
-        // 클릭된 디렉토리의 절대 경로를 생성
-        char absolutePath[PATH_MAX];
-        realpath(clickedPath, absolutePath);
+    // 초기 탐색은 감시 스레드가 나눠 주는 시간 조각 안에서만 진행
+    // (조각 사이에는 모든 탐색 스레드가 멈춰 있으므로 감시 스레드가 잠금 없이 감시 테이블을 읽을 수 있음)
+    bool sliced;
+    pthread_mutex_t sliceLock;
+    pthread_cond_t sliceStart;        // 새 시간 조각 시작 또는 종료 요청
+    pthread_cond_t sliceDone;         // 탐색 스레드가 조각을 마치고 멈추거나 끝남
+    uint32_t slice;                   // 시간 조각 번호 (0이면 시작 전)
+    int64_t sliceEndMs;               // 이번 조각 마감 시각 (monotonic)
+    int parked;                       // 이번 조각을 마치고 멈춘 스레드 수
+    int exited;                       // 끝난 스레드 수
+    bool stopping;                    // 탐색 중단 요청 (프로그램 종료)
+} Crawl;
 
-        printf("Double-clicked directory: %s\n", absolutePath); // 디버깅 출력
+// 탐색 스레드 인자
+typedef struct {
+    Crawl* crawl;
+    int id;                           // 자신의 덱 번호
+} CrawlWorker;
 
-        GtkStyleContext *context = gtk_widget_get_style_context(widget);
-        if (gtk_style_context_has_class(context, "highlighted")) {
-            gtk_style_context_remove_class(context, "highlighted");
-        }
-        
-        // 디렉토리 내용을 표시
-        show_directory_contents(absolutePath);
-    }
-}
+// 초기 탐색 진행 상황 (감시 스레드가 시간 조각마다 갱신하고 UI 타이머가 읽음)
+typedef struct {
+    uint64_t directories;             // 감시를 건 디렉토리 수
+    uint64_t entries;                 // 읽은 디렉토리 항목 수
+    uint64_t queued;                  // 감시는 걸었지만 아직 읽지 않은 디렉토리 수
+    int64_t elapsedMs;                // 탐색 시작 후 지난 시간
+    int finished;                     // 탐색 완료 여부
+} CrawlProgress;
 
-void show_directory_contents(const char *directory) {
-    // 기존 내용 삭제
-    GList *children = gtk_container_get_children(GTK_CONTAINER(directoryContentsBox));
-    for (GList *iter = children; iter != NULL; iter = iter->next) {
-        gtk_widget_destroy(GTK_WIDGET(iter->data));
-    }
-    g_list_free(children);
+// (wd, name) 별로 병합 대기 중인 이벤트
+typedef struct PendingEvent {
+    int wd;                           // 디렉토리의 watch descriptor
+    uint32_t firstMask;               // 창 안에서 처음 발생한 이벤트
+    uint32_t lastMask;                // 창 안에서 마지막으로 발생한 이벤트
+    uint32_t seenMask;                // 창 안에서 발생한 모든 이벤트의 합
+    uint32_t count;                   // 병합된 이벤트 수
+    int64_t firstTimeNs;              // 처음 이벤트 발생 시각 (나노초)
+    int64_t deadlineMs;               // 병합 창이 끝나는 시각 (monotonic)
+    struct PendingEvent* nextInBucket; // 같은 해시 버킷의 다음 항목
+    struct PendingEvent* nextInQueue;  // 발생 순서 큐의 다음 항목
+    struct PendingEvent* prevInQueue;  // 발생 순서 큐의 이전 항목
+    char name[NAME_MAX + 1];          // 파일 이름
+} PendingEvent;
 
-    // 디렉토리 열기
-    DIR *dir = opendir(directory);
-    if (!dir) {
-        perror("Error opening directory");
-        return;
-    }
+PendingEvent* pendingBuckets[COALESCE_BUCKETS]; // (wd, name) 해시 테이블
+PendingEvent* pendingQueueHead = NULL;          // 가장 먼저 마감되는 항목
+PendingEvent* pendingQueueTail = NULL;          // 가장 최근에 추가된 항목
+PendingEvent* pendingFreeList = NULL;           // 재사용 가능한 항목
+PendingEvent* pendingPool = NULL;               // 미리 할당한 항목 저장 공간
 
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue; // 현재 디렉토리와 부모 디렉토리는 무시
-        }
+// IN_MOVED_TO를 기다리는 IN_MOVED_FROM 이벤트
+typedef struct {
+    uint32_t cookie;                  // 이동 이벤트 짝을 맞추는 커널 쿠키
+    int wd;                           // 원래 디렉토리의 watch descriptor
+    uint32_t mask;                    // IN_MOVED_FROM (| IN_ISDIR)
+    int64_t eventTimeNs;              // 이벤트 발생 시각 (나노초)
+    int64_t deadlineMs;               // 짝을 기다리는 마감 시각 (monotonic)
+    char name[NAME_MAX + 1];          // 원래 이름
+} PendingMove;
 
-        // 항목의 전체 경로 생성
-        char fullPath[PATH_MAX];
-        snprintf(fullPath, sizeof(fullPath), "%s/%s", directory, entry->d_name);
+PendingMove pendingMoves[MOVE_PAIR_MAX]; // 짝을 기다리는 이동 이벤트 (원형 큐)
+size_t pendingMoveHead = 0;              // 가장 오래된 항목 위치
+size_t pendingMoveTail = 0;              // 다음에 추가할 위치
 
-        // 레이블 생성
-        GtkWidget *eventBox = gtk_event_box_new();
-        GtkWidget *label = gtk_label_new(entry->d_name);
+// 이벤트 묶음을 읽은 시각 (묶음 안의 모든 이벤트가 공유)
+typedef struct {
+    int64_t realtimeNs;               // CLOCK_REALTIME (나노초)
+    int64_t monotonicNs;              // CLOCK_MONOTONIC (나노초)
+} EventClock;
 
-        gtk_widget_set_halign(label, GTK_ALIGN_START);
-        gtk_container_add(GTK_CONTAINER(eventBox), label);
+// 스레드별 시각 문자열 캐시 (같은 초 안에서는 날짜와 시각 부분을 다시 만들지 않음)
+typedef struct {
+    time_t second;                    // 캐시된 초 (-1이면 없음)
+    char text[EVENT_TIMESTAMP_LENGTH + 1]; // "YYYY-MM-DD HH:MM:SS"
+} TimestampCache;
 
-        // 더블 클릭 이벤트 연결
-        char *pathCopy = strdup(fullPath); // 경로를 복사해 이벤트 핸들러로 전달
-        gtk_widget_add_events(eventBox, GDK_BUTTON_PRESS_MASK);
-        g_signal_connect(eventBox, "button-press-event", G_CALLBACK(on_directory_double_click), pathCopy);
+EventClock batchClock;                   // 감시 스레드가 마지막으로 읽은 이벤트 묶음의 시각
+__thread TimestampCache timestampCache = { -1, "" };
+struct timespec lastQueueDrainedTime;    // inotify 큐를 마지막으로 끝까지 비운 시각 (realtime)
+uint32_t recentNodes[RECENT_ACTIVITY_MAX]; // 최근 이벤트가 발생한 디렉토리 노드 (원형 버퍼)
+size_t recentNodeCount = 0;              // 지금까지 기록한 수
+uint32_t* rescanQueue = NULL;            // 오버플로 재검사할 디렉토리 노드 큐
+size_t rescanHead = 0;                   // 다음에 재검사할 위치
+size_t rescanCount = 0;                  // 큐 끝 위치
+size_t rescanCapacity = 0;               // 큐 할당 크기
+struct timespec rescanSince;             // 이 시각 이후 수정된 파일은 변경된 것으로 간주
+int64_t rescanStartMs = 0;               // 재검사 시작 시각 (monotonic)
+uint64_t rescanDirectories = 0;          // 재검사한 디렉토리 수
+uint64_t rescanDifferences = 0;          // 재검사로 찾아낸 차이 수
 
-        gtk_container_add(GTK_CONTAINER(directoryContentsBox), eventBox);
-        gtk_widget_show_all(eventBox);
-    }
+// fanotify 백엔드의 감시 루트 (표시는 루트가 속한 파일 시스템 전체에 걸림)
+typedef struct {
+    char* realPath;                   // 심볼릭 링크를 푼 루트 경로 (핸들에서 얻은 경로와 비교)
+    size_t length;                    // realPath 길이
+    uint32_t node;                    // 루트 노드
+    int mountFd;                      // open_by_handle_at 기준 fd
+    __kernel_fsid_t fsid;             // 루트가 속한 파일 시스템 ID
+} FanotifyRoot;
 
-    closedir(dir);
-}
+// 디렉토리 파일 핸들 -> 노드 wd 캐시 항목 (직접 사상, 충돌하면 덮어씀)
+typedef struct {
+    bool used;
+    __kernel_fsid_t fsid;
+    int handleType;
+    uint32_t handleBytes;
+    unsigned char handle[FANOTIFY_HANDLE_MAX];
+    int wd;                           // 디렉토리 노드의 wd (-1이면 감시 루트 밖)
+    uint32_t generation;              // 루트 밖이라고 판정했을 때의 디렉토리 이동 세대
+} HandleCacheEntry;
 
-// 디렉토리 목록에 아이템 추가
-void add_directory_to_list(const char *directory) {
-    GtkWidget *eventBox = gtk_event_box_new();
-    GtkWidget *label = gtk_label_new(directory);
+FanotifyRoot* fanotifyRoots = NULL;      // 감시 루트 목록
+int fanotifyRootCount = 0;               // 감시 루트 수
+HandleCacheEntry* handleCache = NULL;    // 디렉토리 핸들 캐시
+int fanotifyNextWd = 1;                  // 노드에 붙일 다음 wd (커널 watch가 없으므로 직접 발급)
+uint32_t fanotifyMoveGeneration = 0;     // 디렉토리가 이동할 때마다 증가 (루트 밖 판정 무효화)
+uint32_t fanotifyNextCookie = 0;         // 이름 변경 짝에 붙일 쿠키
+bool fanotifyRenameEvents = true;        // FAN_RENAME 사용 여부 (아니면 FAN_MOVED_FROM/TO)
+uint32_t fanotifyMovedFromCookie = 0;    // 직전 이벤트가 FAN_MOVED_FROM이면 그 쿠키 (FAN_RENAME이 없을 때 짝 맞추기)
 
-    gtk_widget_set_halign(label, GTK_ALIGN_START);
-    gtk_container_add(GTK_CONTAINER(eventBox), label);
+// 단일 생산자/단일 소비자 lock-free 링 버퍼
+typedef struct {
+    size_t head __attribute__((aligned(CACHE_LINE_SIZE))); // 소비자가 다음에 읽을 위치
+    size_t cachedTail;                // 소비자가 마지막으로 본 tail
+    size_t tail __attribute__((aligned(CACHE_LINE_SIZE))); // 생산자가 다음에 쓸 위치
+    size_t cachedHead;                // 생산자가 마지막으로 본 head
+    uint64_t dropped;                 // 링이 가득 차서 버려진 레코드 수 (생산자만 증가)
+    size_t capacity __attribute__((aligned(CACHE_LINE_SIZE))); // 슬롯 개수 (2의 거듭제곱)
+    size_t recordSize;                // 슬롯 하나의 크기
+    char* slots;                      // 레코드 저장 공간
+} SpscRing;
 
-    // 더블 클릭 이벤트 연결
-    char *pathCopy = strdup(directory); // 경로 복사
-    gtk_widget_add_events(eventBox, GDK_BUTTON_PRESS_MASK);
-    g_signal_connect(eventBox, "button-press-event", G_CALLBACK(on_directory_double_click), pathCopy);
+SpscRing uiRing;                      // 감시 스레드 -> GTK 스레드 이벤트 링
+int uiFrameScheduled = 0;             // UI 프레임 타이머가 예약되어 있는지 여부
+int64_t lastUiFrameMs = 0;            // 마지막 UI 프레임 시각 (monotonic)
+pthread_mutex_t highlightLock = PTHREAD_MUTEX_INITIALIZER; // highlightQueue 보호
+HighlightRequest* highlightQueue = NULL; // 감시 스레드가 채우는 강조 목록
+size_t highlightCount = 0;
+size_t highlightCapacity = 0;
+HighlightRequest* highlightSpare = NULL; // GTK 스레드가 처리를 마친 목록 (다음 교체 때 재사용)
+size_t highlightSpareCapacity = 0;
+uint64_t uiDroppedReported = 0;       // UI에 이미 보고한 누락 이벤트 수
 
-    // 클릭 이벤트 연결
-    g_signal_connect(eventBox, "button-press-event", G_CALLBACK(on_directory_clicked), NULL);
+SpscRing logRing;                     // 감시 스레드 -> 로그 기록 스레드 이벤트 링
+int LogWakeupFd = -1;                 // 잠든 로그 기록 스레드를 깨우는 eventfd
+int logWriterSleeping = 0;            // 기록 스레드가 잠들어 있어 깨워야 하는지 여부
+volatile sig_atomic_t logWriterRunning = 1; // 로그 기록 스레드 실행 여부
+pthread_t logWriterThread;            // 로그 기록 스레드
+uint64_t eventSequence = 0;           // 마지막으로 붙인 이벤트 순서 번호 (감시 스레드만 변경)
+int64_t runEpochNs = 0;               // 이번 실행을 구분하는 값 (시작 시각, 커서 토큰에 들어감)
 
-    gtk_container_add(GTK_CONTAINER(directoryListBox), eventBox);
-    gtk_widget_show_all(eventBox);
+// 변경 색인 항목: 경로마다 하나, 마지막 변경 순서대로 연결
+typedef struct {
+    char* path;
+    uint64_t hash;
+    uint64_t sequence;                // 마지막으로 바뀐 이벤트 순서 번호
+    int64_t timeNs;                   // 마지막으로 바뀐 시각
+    uint32_t mask;                    // 마지막 변경의 이벤트 마스크
+    int32_t hashNext;                 // 같은 버킷의 다음 항목
+    int32_t prev;                     // 더 오래된 변경
+    int32_t next;                     // 더 최근 변경
+} ChangeEntry;
 
-    for (int i = 0; i < watchDescriptorCount; ++i) {
-        if (strcmp(watchDescriptors[i].path, directory) == 0) {
-            watchDescriptors[i].eventBox = eventBox;
-            break;
-        }
-    }
-}
+// 변경 색인 (감시 스레드만 사용)
+typedef struct {
+    ChangeEntry* entries;
+    int32_t* buckets;                 // 경로 해시 -> 첫 항목 (-1이면 없음)
+    uint32_t bucketMask;
+    int32_t count;
+    int32_t oldest;                   // 가장 오래 전에 바뀐 항목
+    int32_t newest;                   // 가장 최근에 바뀐 항목
+    uint64_t floorSequence;           // 이 번호 이전의 변경은 색인에서 빠졌을 수 있음
+} ChangeIndex;
 
-// 로그 파일 초기화 함수
-void init_log_file(const char* path) {
-    logFile = fopen(path, "a"); // 로그 파일 열기 (추가 모드)
-    if (!logFile) {
-        perror("Error opening log file"); // 파일 열기 실패 시 오류 메시지 출력
-        exit(EXIT_FAILURE); // 프로그램 종료
-    }
-    printf("Log file initialized at: %s\n", path); // 로그 파일 초기화 완료 메시지 출력
-}
+ChangeIndex changeIndex;
 
-void init_log_ui() {
-    gtk_init(NULL, NULL);
+// 구독 소켓 클라이언트 (감시 스레드의 epoll 루프에서만 다룸)
+typedef struct {
+    int fd;
+    bool subscribed;                  // 구독 요청을 받았는지 여부
+    bool requestDeferred;             // 답할 공간이 생길 때까지 요청 줄 처리를 미루는 중인지 여부
+    uint32_t epollEvents;             // epoll에 등록한 이벤트 (EPOLLIN/EPOLLOUT)
+    char request[SUBSCRIBER_REQUEST_MAX]; // 받는 중인 구독 요청 줄
+    size_t requestLength;
+    char root[PATH_MAX];              // 이 경로 아래의 이벤트만 받음
+    size_t rootLength;
+    uint32_t mask;                    // 받을 이벤트 종류
+    char suffix[64];                  // 이름 접미사 필터 (비어 있으면 전체)
+    char* buffer;                     // 보내지 못한 프레임 (bounded)
+    size_t head;                      // 다음에 보낼 위치
+    size_t tail;                      // 다음에 쓸 위치
+    uint64_t dropped;                 // 버퍼가 가득 차서 버린 뒤 아직 알리지 않은 이벤트 수
+} Subscriber;
 
-    // 메인 윈도우 생성
-    logWindow = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-    gtk_window_set_title(GTK_WINDOW(logWindow), "File Monitor Logs");
-    gtk_window_set_default_size(GTK_WINDOW(logWindow), 1000, 600);
+EventRingHeader* eventRing = NULL;    // 공유 메모리 이벤트 링 (감시 스레드만 씀)
+EventRingSlot* eventRingSlotArray = NULL;
+size_t eventRingMapSize = 0;
 
-    // === 상단 영역: 디렉토리 목록 ===
-    GtkWidget *directoryHeader = gtk_header_bar_new();
-    gtk_header_bar_set_title(GTK_HEADER_BAR(directoryHeader), "Monitoring Directories");
-    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(directoryHeader), FALSE);
+int SubscribeServerFd = -1;           // 구독 소켓 (듣기)
+Subscriber* subscribers[SUBSCRIBER_MAX]; // 연결된 구독자
+int subscriberCount = 0;
+off_t logFileSize = 0;                // 현재 로그 파일 크기
+time_t logSegmentStart = 0;           // 현재 로그 파일을 연 시각
 
-    directoryListBox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-    GtkWidget *topScrollWindow = gtk_scrolled_window_new(NULL, NULL);
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(topScrollWindow), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-    gtk_container_add(GTK_CONTAINER(topScrollWindow), directoryListBox);
+// 압축을 기다리는 로그 조각
+typedef struct LogSegment {
+    struct LogSegment* next;
+    char path[];                      // 교체된 로그 조각 경로
+} LogSegment;
 
-    GtkWidget *topFrame = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-    gtk_box_pack_start(GTK_BOX(topFrame), directoryHeader, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(topFrame), topScrollWindow, TRUE, TRUE, 0);
+pthread_mutex_t soundLock = PTHREAD_MUTEX_INITIALIZER; // 사운드 요청 대기 보호
+pthread_cond_t soundReady;            // 사운드 요청 또는 종료 요청 (CLOCK_MONOTONIC)
+int soundRequested = 0;               // 아직 재생하지 않은 사운드 요청이 있는지 여부 (여러 요청은 하나로 합침)
+bool soundRunning = false;            // 사운드 스레드 실행 여부
+pthread_t soundThread;                // 사운드 스레드 (ca_context를 계속 유지)
 
-    // === 오른쪽 영역: 디렉토리 내용 ===
-    GtkWidget *contentsHeader = gtk_header_bar_new();
-    gtk_header_bar_set_title(GTK_HEADER_BAR(contentsHeader), "Directory Contents");
-    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(contentsHeader), FALSE);
+pthread_mutex_t compressLock = PTHREAD_MUTEX_INITIALIZER; // 압축 큐 보호
+pthread_cond_t compressReady = PTHREAD_COND_INITIALIZER;  // 압축할 조각이 생기거나 종료 요청
+LogSegment* compressQueueHead = NULL;  // 압축 대기 큐 (먼저 교체된 조각부터)
+LogSegment* compressQueueTail = NULL;
+bool compressorRunning = false;        // 압축 스레드 실행 여부
+pthread_t compressorThread;            // 낮은 우선순위 압축 스레드
 
-    directoryContentsBox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-    GtkWidget *contentsScrollWindow = gtk_scrolled_window_new(NULL, NULL);
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(contentsScrollWindow), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-    gtk_container_add(GTK_CONTAINER(contentsScrollWindow), directoryContentsBox);
+// 저널 경로 중복 제거 표 슬롯
+typedef struct {
+    uint32_t id;                      // 문자열 ID (JOURNAL_PATH_NONE이면 빈 슬롯)
+    uint32_t hash;                    // 경로 해시 하위 32비트
+} JournalStringSlot;
 
-    GtkWidget *contentsFrame = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-    gtk_box_pack_start(GTK_BOX(contentsFrame), contentsHeader, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(contentsFrame), contentsScrollWindow, TRUE, TRUE, 0);
+// 바이너리 저널 기록 상태 (로그 기록 스레드만 사용)
+int JournalFd = -1;                           // 레코드 파일
+int JournalStringFd = -1;                     // 문자열 표 파일
+int JournalIndexFd = -1;                      // 색인 파일
+uint64_t journalSequence = 0;                 // 다음 레코드 순서 번호
+char* journalStrings = NULL;                  // 문자열 표 파일 내용 (헤더 포함, 중복 비교용)
+size_t journalStringSize = 0;                 // 문자열 표 크기
+size_t journalStringFlushed = 0;              // 파일에 기록한 문자열 표 크기
+size_t journalStringCapacity = 0;             // journalStrings 할당 크기
+JournalStringSlot* journalStringSlots = NULL; // 경로 -> 문자열 ID 표 (선형 탐사)
+size_t journalStringSlotCapacity = 0;         // 슬롯 개수 (2의 거듭제곱)
+size_t journalStringSlotUsed = 0;             // 사용 중인 슬롯 수
+JournalRecord journalPending[JOURNAL_WRITE_BATCH]; // 아직 기록하지 않은 레코드
+int journalPendingCount = 0;                  // journalPending에 있는 레코드 수
+JournalIndexBlock journalBlock;               // 채우는 중인 색인 블록
+uint32_t journalBlockRecords = 0;             // 현재 색인 블록의 레코드 수
 
-    // === 하단 영역: 로그 창 ===
-    GtkWidget *logHeader = gtk_header_bar_new();
-    gtk_header_bar_set_title(GTK_HEADER_BAR(logHeader), "Event Logs");
-    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(logHeader), FALSE);
+// 32비트 해시 섞기 (murmur3 finalizer)
+uint32_t mix32(uint32_t hash) {
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
 
-    logTextView = gtk_text_view_new();
-    gtk_text_view_set_editable(GTK_TEXT_VIEW(logTextView), FALSE);
-    logBuffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(logTextView));
+// wd 해시
+uint32_t hash_wd(int wd) {
+    return mix32((uint32_t)wd);
+}
 
-    GtkWidget *logScrollWindow = gtk_scrolled_window_new(NULL, NULL);
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(logScrollWindow), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-    gtk_container_add(GTK_CONTAINER(logScrollWindow), logTextView);
+// (부모 노드, 이름 ID) 해시
+uint32_t hash_child(uint32_t parent, uint32_t name) {
+    return mix32(parent * 2654435761u ^ name);
+}
 
-    GtkWidget *bottomFrame = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
-    gtk_box_pack_start(GTK_BOX(bottomFrame), logHeader, FALSE, FALSE, 0);
-    gtk_box_pack_start(GTK_BOX(bottomFrame), logScrollWindow, TRUE, TRUE, 0);
+// 문자열 해시 (FNV-1a)
+uint32_t hash_string(const char* text) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)text; *c; ++c) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
-    // === 전체 레이아웃 ===
-    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5); // 상단+오른쪽 수평 박스
-    gtk_box_pack_start(GTK_BOX(hbox), topFrame, TRUE, TRUE, 0);   // 상단 영역
-    gtk_box_pack_start(GTK_BOX(hbox), contentsFrame, TRUE, TRUE, 0); // 오른쪽 영역
+// 인덱스 초기화
+int watch_index_init(WatchIndex* index, size_t capacity) {
+    index->entries = malloc(capacity * sizeof(WatchIndexEntry));
+    if (!index->entries) return -1;
+    for (size_t i = 0; i < capacity; ++i) {
+        index->entries[i].slot = WATCH_INDEX_EMPTY;
+    }
+    index->capacity = capacity;
+    index->used = 0;
+    return 0;
+}
 
-    GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5); // 수직 레이아웃
-    gtk_box_pack_start(GTK_BOX(vbox), hbox, TRUE, TRUE, 0);     // 상단+오른쪽
-    gtk_box_pack_end(GTK_BOX(vbox), bottomFrame, TRUE, TRUE, 0); // 하단 로그
+// 인덱스에 항목 추가 (중복 검사는 호출자가 담당)
+void watch_index_put(WatchIndex* index, uint32_t key, int slot);
 
-    gtk_container_add(GTK_CONTAINER(logWindow), vbox);
+// 부하율이 70%를 넘으면 두 배 크기로 재구성 (삭제 표시 슬롯도 정리)
+void watch_index_grow(WatchIndex* index) {
+    WatchIndex old = *index;
+    if (watch_index_init(index, old.capacity * 2) == -1) {
+        *index = old;
+        fprintf(stderr, "Error growing watch index\n");
+        return;
+    }
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (old.entries[i].slot >= 0) {
+            watch_index_put(index, old.entries[i].key, old.entries[i].slot);
+        }
+    }
+    free(old.entries);
+}
 
-    // 창 닫기 이벤트 처리
-    g_signal_connect(logWindow, "destroy", G_CALLBACK(gtk_main_quit), NULL);
+void watch_index_put(WatchIndex* index, uint32_t key, int slot) {
+    if ((index->used + 1) * 10 > index->capacity * 7) {
+        watch_index_grow(index);
+    }
 
-    gtk_widget_show_all(logWindow);
+    size_t mask = index->capacity - 1;
+    for (size_t i = key & mask;; i = (i + 1) & mask) {
+        if (index->entries[i].slot < 0) {
+            if (index->entries[i].slot == WATCH_INDEX_EMPTY) index->used++;
+            index->entries[i].key = key;
+            index->entries[i].slot = slot;
+            return;
+        }
+    }
 }
 
-gboolean update_ui(gpointer data) {
-    const char* eventMessage = (const char*)data;
-    GtkTextIter endIter;
-
-    // 텍스트 버퍼의 끝에 메시지 추가
-    gtk_text_buffer_get_end_iter(logBuffer, &endIter);
-    gtk_text_buffer_insert(logBuffer, &endIter, eventMessage, -1);
-    gtk_text_buffer_insert(logBuffer, &endIter, "\n", -1);
+// 인덱스에서 항목 제거 (삭제 표시만 남겨 탐사 순서 유지)
+void watch_index_remove(WatchIndex* index, uint32_t key, int slot) {
+    size_t mask = index->capacity - 1;
+    for (size_t i = key & mask; index->entries[i].slot != WATCH_INDEX_EMPTY; i = (i + 1) & mask) {
+        if (index->entries[i].slot == slot && index->entries[i].key == key) {
+            index->entries[i].slot = WATCH_INDEX_DELETED;
+            return;
+        }
+    }
+}
 
-    free(data);
+// 이름 ID를 문자열로 변환
+const char* name_string(uint32_t name) {
+    return nameChunks[name >> NAME_CHUNK_SHIFT] + (name & (NAME_CHUNK_SIZE - 1));
+}
 
-    return FALSE;
+// 이미 저장된 이름 찾기 (없으면 NAME_NONE)
+uint32_t find_name(const char* text) {
+    uint32_t key = hash_string(text);
+    size_t mask = nameIndex.capacity - 1;
+    for (size_t i = key & mask; nameIndex.entries[i].slot != WATCH_INDEX_EMPTY; i = (i + 1) & mask) {
+        if (nameIndex.entries[i].slot >= 0 && nameIndex.entries[i].key == key &&
+            strcmp(name_string((uint32_t)nameIndex.entries[i].slot), text) == 0) {
+            return (uint32_t)nameIndex.entries[i].slot;
+        }
+    }
+    return NAME_NONE;
 }
 
+// 이름을 이름 풀에 한 번만 저장하고 ID 반환 (실패 시 NAME_NONE)
+uint32_t intern_name(const char* text) {
+    uint32_t name = find_name(text);
+    if (name != NAME_NONE) return name;
 
-// 로그 이벤트 함수
-void log_event(const char* eventMessage) {
-    if (!eventMessage || strlen(eventMessage) == 0) {
-        fprintf(stderr, "Invalid event message\n");
-        return;
+    size_t length = strlen(text) + 1;
+    if (length > NAME_CHUNK_SIZE) return NAME_NONE;
+
+    if (nameChunkUsed + length > NAME_CHUNK_SIZE) { // 새 청크 할당
+        if (nameChunkCount == nameChunkCapacity) {
+            uint32_t capacity = nameChunkCapacity ? nameChunkCapacity * 2 : 16;
+            char** chunks = realloc(nameChunks, capacity * sizeof(char*));
+            if (!chunks) return NAME_NONE;
+            nameChunks = chunks;
+            nameChunkCapacity = capacity;
+        }
+        nameChunks[nameChunkCount] = malloc(NAME_CHUNK_SIZE);
+        if (!nameChunks[nameChunkCount]) return NAME_NONE;
+        nameChunkCount++;
+        nameChunkUsed = 0;
     }
 
-    // 메시지를 복사하여 GTK 메인 스레드에 전달
-    char* messageCopy = strdup(eventMessage);
-    g_idle_add(update_ui, messageCopy);
+    name = ((nameChunkCount - 1) << NAME_CHUNK_SHIFT) | nameChunkUsed;
+    memcpy(nameChunks[nameChunkCount - 1] + nameChunkUsed, text, length);
+    nameChunkUsed += (uint32_t)length;
 
-    printf("%s\n", eventMessage);
+    watch_index_put(&nameIndex, hash_string(text), (int)name);
+    return name;
 }
 
-// 설정 파일에서 디렉토리 및 로그 파일 경로 읽기
-void read_config(const char* configPath, char monitoredDirs[][512], int* dirCount) {
-    config_t cfg; // libconfig 설정 객체
-    config_init(&cfg); // 설정 객체 초기화
-
-    if (!config_read_file(&cfg, configPath)) {  // 설정 파일 읽기
-        fprintf(stderr, "Error reading config file %s: %s\n", configPath, config_error_text(&cfg));
-        config_destroy(&cfg);  // 설정 객체 해제
-        exit(EXT_ERR_CONFIG_FILE); // 설정 파일 오류 시 종료
+// wd로 노드 찾기 (없으면 -1)
+int find_watch_by_wd(int wd) {
+    uint32_t key = hash_wd(wd);
+    size_t mask = wdIndex.capacity - 1;
+    for (size_t i = key & mask; wdIndex.entries[i].slot != WATCH_INDEX_EMPTY; i = (i + 1) & mask) {
+        int slot = wdIndex.entries[i].slot;
+        if (slot >= 0 && watchNodes[slot].wd == wd) {
+            return slot;
+        }
     }
+    return -1;
+}
 
-    const char* logPath = NULL;
-    if (config_lookup_string(&cfg, "log_file", &logPath)) { // 설정 파일에서 'log_file' 항목 읽기
-        strncpy(logFilePath, logPath, sizeof(logFilePath));  // 로그 파일 경로 저장
-    }
-    else {
-        fprintf(stderr, "Missing 'log_file' in config file\n");
-        config_destroy(&cfg); // 설정 객체 해제
-        exit(EXT_ERR_CONFIG_FILE); // 로그 파일 경로가 없으면 종료
+// 부모 노드 아래에서 이름으로 자식 노드 찾기 (없으면 -1)
+int find_child_watch(uint32_t parent, uint32_t name) {
+    uint32_t key = hash_child(parent, name);
+    size_t mask = childIndex.capacity - 1;
+    for (size_t i = key & mask; childIndex.entries[i].slot != WATCH_INDEX_EMPTY; i = (i + 1) & mask) {
+        int slot = childIndex.entries[i].slot;
+        if (slot >= 0 && watchNodes[slot].parent == parent && watchNodes[slot].name == name) {
+            return slot;
+        }
     }
+    return -1;
+}
 
-    const char* filterExt = NULL;
-    if (config_lookup_string(&cfg, "filtered_extension", &filterExt)) { // 필터링할 확장자 읽기
-        strncpy(filteredExtension, filterExt, sizeof(filteredExtension)); // 필터링 확장자 저장
+// 부모 노드를 따라 올라가며 전체 경로 조립 (길이 반환, 잘린 경우 -1)
+int watch_build_path(uint32_t node, char* buffer, size_t bufferSize) {
+    uint32_t chain[PATH_MAX / 2]; // 루트까지의 노드 (경로 한 단계는 최소 2바이트)
+    int depth = 0;
+    for (uint32_t current = node; current != WATCH_NODE_NONE; current = watchNodes[current].parent) {
+        if (depth == (int)(sizeof(chain) / sizeof(chain[0]))) return -1;
+        chain[depth++] = current;
     }
 
-    config_setting_t* directories = config_lookup(&cfg, "monitor_directories"); // 디렉토리 목록 읽기
-    if (directories) {
-        if (config_setting_is_array(directories)) { // 'monitor_directories'가 배열인지 확인
-            int count = config_setting_length(directories); // 배열의 길이 (디렉토리 개수)
-            for (int i = 0; i < count && i < 512; ++i) { // 디렉토리 경로를 배열에 저장
-                const char* dir = config_setting_get_string_elem(directories, i);
-                strncpy(monitoredDirs[i], dir, 512); // 디렉토리 경로 저장
-            }
-            *dirCount = count; // 디렉토리 개수 설정
-        }
-        else {
-            fprintf(stderr, "'monitor_directories' must be an array in config file\n");
-            config_destroy(&cfg); // 설정 객체 해제
-            exit(EXT_ERR_CONFIG_FILE); // 배열이 아니면 종료
+    size_t length = 0;
+    for (int i = depth - 1; i >= 0; --i) {
+        const char* name = name_string(watchNodes[chain[i]].name);
+        size_t nameLength = strlen(name);
+        size_t needed = nameLength + (i == depth - 1 ? 0 : 1);
+        if (length + needed >= bufferSize) {
+            buffer[length] = '\0';
+            return -1;
         }
+        if (i != depth - 1) buffer[length++] = '/';
+        memcpy(buffer + length, name, nameLength);
+        length += nameLength;
     }
-    else {
-        fprintf(stderr, "Missing 'monitor_directories' in config file\n");
-        config_destroy(&cfg); // 설정 객체 해제
-        exit(EXT_ERR_CONFIG_FILE); // 디렉토리가 없으면 종료
+    buffer[length] = '\0';
+    return (int)length;
+}
+
+// 항목 집합에서 이름 ID가 있는 슬롯 위치 찾기 (없으면 비어 있는 슬롯 위치)
+uint32_t entry_set_slot(const EntrySet* set, uint32_t name) {
+    uint32_t mask = set->capacity - 1;
+    uint32_t i = mix32(name) & mask;
+    while (set->slots[i] != NAME_NONE && set->slots[i] != name) {
+        i = (i + 1) & mask;
     }
+    return i;
+}
 
-    config_destroy(&cfg); // 설정 객체 해제
+// 항목 집합에 이름 ID가 있는지 확인
+bool entry_set_contains(const EntrySet* set, uint32_t name) {
+    return set->capacity > 0 && set->slots[entry_set_slot(set, name)] == name;
 }
 
-// 디렉토리 감시 추가 함수 (하위 디렉토리도 포함)
-void add_watch_recursive(const char *path) {
-    DIR *dir = opendir(path);
-    if (!dir) {
-        perror("Error opening directory");
-        return;
-    }
+// 항목 집합에 이름 ID 추가 (부하율 75%를 넘으면 두 배로 확장)
+bool entry_set_add(EntrySet* set, uint32_t name) {
+    if ((set->count + 1) * 4 > set->capacity * 3) {
+        uint32_t capacity = set->capacity ? set->capacity * 2 : ENTRY_SET_INITIAL_CAPACITY;
+        uint32_t* slots = malloc(capacity * sizeof(uint32_t));
+        if (!slots) return false;
+        memset(slots, 0xff, capacity * sizeof(uint32_t)); // NAME_NONE으로 채움
 
-    struct dirent *entry;
-    while ((entry = readdir(dir)) != NULL) {
-        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-            continue;
+        EntrySet grown = { slots, 0, capacity };
+        for (uint32_t i = 0; i < set->capacity; ++i) {
+            if (set->slots[i] != NAME_NONE) {
+                grown.slots[entry_set_slot(&grown, set->slots[i])] = set->slots[i];
+                grown.count++;
+            }
         }
+        free(set->slots);
+        *set = grown;
+    }
 
-        char subPath[512];
-        snprintf(subPath, sizeof(subPath), "%s/%s", path, entry->d_name);
+    uint32_t i = entry_set_slot(set, name);
+    if (set->slots[i] == NAME_NONE) {
+        set->slots[i] = name;
+        set->count++;
+    }
+    return true;
+}
 
-        struct stat pathStat;
-        if (stat(subPath, &pathStat) == 0 && S_ISDIR(pathStat.st_mode)) { // 하위 디렉토리 확인
-            add_watch_recursive(subPath);
+// 항목 집합에서 이름 ID 제거 (뒤따르는 항목을 당겨 삭제 표시 없이 유지)
+void entry_set_remove(EntrySet* set, uint32_t name) {
+    if (set->capacity == 0) return;
+    uint32_t mask = set->capacity - 1;
+    uint32_t hole = entry_set_slot(set, name);
+    if (set->slots[hole] == NAME_NONE) return;
+
+    set->slots[hole] = NAME_NONE;
+    set->count--;
+    for (uint32_t i = (hole + 1) & mask; set->slots[i] != NAME_NONE; i = (i + 1) & mask) {
+        uint32_t home = mix32(set->slots[i]) & mask;
+        // home이 (hole, i] 구간 밖이면 hole로 당겨야 탐색이 끊기지 않음
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            set->slots[hole] = set->slots[i];
+            set->slots[i] = NAME_NONE;
+            hole = i;
         }
     }
+}
 
-    int wd = inotify_add_watch(IeventQueue, path, IN_CREATE | IN_DELETE | IN_MODIFY | IN_MOVE_SELF);
-    if (wd == -1) {
-        fprintf(stderr, "Error adding watch for %s\n", path);
-    } else {
-        strncpy(watchDescriptors[watchDescriptorCount].path, path, 512);
-        watchDescriptors[watchDescriptorCount].wd = wd;
-        watchDescriptorCount++;
+// 항목 집합 해제
+void entry_set_free(EntrySet* set) {
+    free(set->slots);
+    set->slots = NULL;
+    set->count = set->capacity = 0;
+}
 
-        printf("Watching: %s\n", path); // 콘솔에 출력
-        add_directory_to_list(path); // 디렉토리 목록에 추가
-    }
+// 노드를 부모의 하위 목록과 자식 인덱스에 연결 (watchTableLock을 잡고 호출)
+void link_watch_node(uint32_t node, uint32_t parent, uint32_t name) {
+    watchNodes[node].parent = parent;
+    watchNodes[node].name = name;
+    watchNodes[node].prevSibling = WATCH_NODE_NONE;
+    watchNodes[node].nextSibling = WATCH_NODE_NONE;
+    if (parent == WATCH_NODE_NONE) return;
 
-    closedir(dir);
+    uint32_t first = watchNodes[parent].firstChild;
+    watchNodes[node].nextSibling = first;
+    if (first != WATCH_NODE_NONE) watchNodes[first].prevSibling = node;
+    watchNodes[parent].firstChild = node;
+
+    watch_index_put(&childIndex, hash_child(parent, name), (int)node);
 }
 
-// watch descriptor를 경로로 변환하는 함수
-const char* get_path_from_wd(int wd) {
-    for (int i = 0; i < watchDescriptorCount; ++i) {
-        if (watchDescriptors[i].wd == wd) { // watch descriptor가 일치하면 경로 반환
-            return watchDescriptors[i].path;
-        }
+// 노드를 부모의 하위 목록과 자식 인덱스에서 분리 (parent 필드는 경로 조립을 위해 유지)
+void unlink_watch_node(uint32_t node) {
+    uint32_t parent = watchNodes[node].parent;
+    if (parent == WATCH_NODE_NONE) return;
+
+    uint32_t prev = watchNodes[node].prevSibling;
+    uint32_t next = watchNodes[node].nextSibling;
+    if (prev != WATCH_NODE_NONE) watchNodes[prev].nextSibling = next;
+    else if (watchNodes[parent].firstChild == node) watchNodes[parent].firstChild = next;
+    if (next != WATCH_NODE_NONE) watchNodes[next].prevSibling = prev;
+    watchNodes[node].prevSibling = watchNodes[node].nextSibling = WATCH_NODE_NONE;
+
+    watch_index_remove(&childIndex, hash_child(parent, watchNodes[node].name), (int)node);
+}
+
+// 디렉토리 이름 변경: 노드 하나만 다시 연결하면 모든 하위 경로가 새 경로를 따름 (O(1))
+int rename_watch_node(uint32_t node, uint32_t newParent, const char* newName) {
+    pthread_mutex_lock(&watchTableLock);
+    uint32_t nameId = intern_name(newName);
+    if (nameId == NAME_NONE) {
+        pthread_mutex_unlock(&watchTableLock);
+        return -1;
     }
-    return "Unknown path"; // 경로를 찾지 못한 경우
+    unlink_watch_node(node);
+    link_watch_node(node, newParent, nameId);
+    pthread_mutex_unlock(&watchTableLock);
+    return 0;
 }
 
-// 파일 확장자 필터링 함수
-int has_filtered_extension(const char* filename) {
-    if (strlen(filteredExtension) == 0) return 0;  // 필터링할 확장자가 없으면 모두 허용
+// 새 노드 등록 (실패 시 -1)
+// 여러 탐색 스레드가 동시에 호출할 수 있음 (이미 감시 중인 wd이면 -2)
+int add_watch_node(int wd, uint32_t parent, const char* name) {
+    pthread_mutex_lock(&watchTableLock);
 
-    const char* ext = strrchr(filename, '.');  // 파일 확장자 찾기
-    if (ext != NULL && strcmp(ext + 1, filteredExtension) == 0) {
-        return 1;  // 필터링 확장자와 일치하면 1 반환
+    int existing = find_watch_by_wd(wd);
+    if (existing >= 0 && !(watchNodes[existing].flags & WATCH_NODE_DEAD)) {
+        pthread_mutex_unlock(&watchTableLock);
+        return -2;
     }
 
-    return 0;  // 확장자가 일치하지 않으면 0 반환
-}
+    uint32_t nameId = intern_name(name);
+    if (nameId == NAME_NONE) {
+        pthread_mutex_unlock(&watchTableLock);
+        return -1;
+    }
 
-// 필터링 확장자 확인 함수 (한 번만 출력)
-void check_filtered_extension() {
-    if (strlen(filteredExtension) > 0) {
-        printf("Filtering files with extension: .%s\n", filteredExtension); // 필터링 확장자 출력
+    uint32_t node;
+    if (watchNodeFreeList != WATCH_NODE_NONE) { // 해제된 노드 재사용
+        node = watchNodeFreeList;
+        watchNodeFreeList = watchNodes[node].parent;
     }
     else {
-        printf("No extensions are filtered\n"); // 필터링 확장자가 없으면 출력
+        if (watchNodeCount == watchNodeCapacity) { // 노드 배열을 두 배로 확장
+            uint32_t capacity = watchNodeCapacity ? watchNodeCapacity * 2 : WATCH_NODE_INITIAL_CAPACITY;
+            WatchNode* nodes = realloc(watchNodes, capacity * sizeof(WatchNode));
+            if (!nodes) {
+                pthread_mutex_unlock(&watchTableLock);
+                return -1;
+            }
+            watchNodes = nodes;
+            watchNodeCapacity = capacity;
+        }
+        node = watchNodeCount++;
     }
-}
 
-// 이벤트 처리 함수
-void process_event(const struct inotify_event* watchEvent) {
-    if (watchEvent->len > 0) {
-        const char* filename = watchEvent->name;
+    watchNodes[node].wd = wd;
+    watchNodes[node].parent = parent;
+    watchNodes[node].name = nameId;
+    watchNodes[node].flags = 0;
+    watchNodes[node].firstChild = WATCH_NODE_NONE;
+    watchNodes[node].entries.slots = NULL;
+    watchNodes[node].entries.count = watchNodes[node].entries.capacity = 0;
+    watchNodes[node].listed = 0;
+    watchNodes[node].highlightPending = 0;
 
-        // 필터링된 확장자일 경우 처리하지 않음
-        if (has_filtered_extension(filename)) {
-            return; // 필터링된 파일은 이벤트를 처리하지 않음
-        }
+    watch_index_put(&wdIndex, hash_wd(wd), (int)node);
+    link_watch_node(node, parent, nameId);
 
-        char notificationMessage[1024]; // 이벤트 메시지 저장
-        char fullPath[512]; // 파일의 전체 경로 저장
-        char eventTime[64]; // 이벤트 발생 시간 저장
-        time_t currentTime = time(NULL); // 현재 시간 얻기
+    pthread_mutex_unlock(&watchTableLock);
+    return (int)node;
+}
 
-        // 발생 시간 포맷팅
-        strftime(eventTime, sizeof(eventTime), "%Y-%m-%d %H:%M:%S", localtime(&currentTime));
+gboolean remove_directory_from_list(gpointer data);
 
-        const char* basePath = get_path_from_wd(watchEvent->wd); // watch descriptor에 해당하는 경로 얻기
-        snprintf(fullPath, sizeof(fullPath), "%s/%s", basePath, watchEvent->name); // 전체 경로 생성
-        snprintf(notificationMessage, sizeof(notificationMessage), "[%s] File %s: ", eventTime, fullPath);
+// 삭제된 디렉토리 노드를 해제 대기 큐로 이동
+// 병합 대기 중인 이벤트가 경로를 조립할 수 있도록 wd 인덱스와 부모 연결은 releaseMs까지 유지
+void retire_watch_node(uint32_t node, int64_t releaseMs) {
+    if (watchNodes[node].flags & WATCH_NODE_DEAD) return;
 
-        for (int i = 0; i < watchDescriptorCount; ++i) {
-            if (strcmp(watchDescriptors[i].path, basePath) == 0 && watchDescriptors[i].eventBox) {
-                GtkStyleContext *context = gtk_widget_get_style_context(watchDescriptors[i].eventBox);
-                gtk_style_context_add_class(context, "highlighted");
-                break;
-            }
-        }
+    // 아직 남아 있는 하위 디렉토리도 함께 해제 (부모가 먼저 재사용되지 않도록)
+    while (watchNodes[node].firstChild != WATCH_NODE_NONE) {
+        uint32_t child = watchNodes[node].firstChild;
+        retire_watch_node(child, releaseMs);
+        if (watchNodes[node].firstChild == child) break; // 해제 큐 할당 실패
+    }
 
-        // 이벤트 종류에 따라 메시지 작성
-        if (watchEvent->mask & IN_CREATE) {
-            strcat(notificationMessage, "created");
+    // 하위 디렉토리가 해제 큐를 채웠을 수 있으므로 자리는 기록 직전에 확보
+    if (retiredCount == retiredCapacity) {
+        if (retiredHead > 0) { // 이미 해제된 앞부분을 정리
+            memmove(retiredWatches, retiredWatches + retiredHead, (retiredCount - retiredHead) * sizeof(RetiredWatch));
+            retiredCount -= retiredHead;
+            retiredHead = 0;
         }
-        else if (watchEvent->mask & IN_DELETE) {
-            strcat(notificationMessage, "deleted");
-        }
-        else if (watchEvent->mask & IN_MODIFY) {
-            strcat(notificationMessage, "modified");
-        }
-        else if (watchEvent->mask & IN_MOVE_SELF) {
-            strcat(notificationMessage, "moved");
+        if (retiredCount == retiredCapacity) {
+            size_t capacity = retiredCapacity ? retiredCapacity * 2 : 256;
+            RetiredWatch* retired = realloc(retiredWatches, capacity * sizeof(RetiredWatch));
+            if (!retired) {
+                fprintf(stderr, "Error retiring watch node\n");
+                return;
+            }
+            retiredWatches = retired;
+            retiredCapacity = capacity;
         }
+    }
 
-        // 마지막 이벤트가 1초 이상 간격을 두고 발생한 경우 로그 기록
-        if (difftime(currentTime, lastEventTime) >= 1) {
-            lastEventTime = currentTime; // 마지막 이벤트 시간 갱신
-            log_event(notificationMessage); // 로그에 이벤트 기록
+    pthread_mutex_lock(&watchTableLock);
+    watchNodes[node].flags |= WATCH_NODE_DEAD;
+    unlink_watch_node(node); // 같은 이름의 새 디렉토리가 바로 생길 수 있으므로 즉시 분리
+    bool listed = watchNodes[node].listed;
+    watchNodes[node].listed = 0;
+    pthread_mutex_unlock(&watchTableLock);
 
-            event_sound();
-        }
+    if (listed) {
+        g_idle_add(remove_directory_from_list, GINT_TO_POINTER(watchNodes[node].wd)); // 행이 있는 디렉토리만 알림
     }
-}
-
-void* inotify_thread(void* arg) {
-    char buffer[4096]; // 이벤트를 받을 버퍼
 
-    while (1) {
-        int readLength = read(IeventQueue, buffer, sizeof(buffer)); // inotify 이벤트 읽기
-        if (readLength == -1) {
-            fprintf(stderr, "Error reading from inotify instance\n");
-            exit(EXT_ERR_READ_INOTIFY); // 이벤트 읽기 실패 시 종료
-        }
+    retiredWatches[retiredCount].node = node;
+    retiredWatches[retiredCount].releaseMs = releaseMs;
+    retiredCount++;
+}
 
-        for (char* buffPointer = buffer; buffPointer < buffer + readLength;) {
-            const struct inotify_event* watchEvent = (const struct inotify_event*)buffPointer; // 이벤트 처리
-            process_event(watchEvent);
-            buffPointer += sizeof(struct inotify_event) + watchEvent->len; // 버퍼 이동
-        }
+// 감시 트리 밖으로 옮겨진 디렉토리 트리의 감시 해제
+// (이동된 디렉토리는 커널이 IN_IGNORED를 보내지 않으므로 직접 해제)
+void prune_watch_subtree(uint32_t node, int64_t releaseMs) {
+    uint32_t next;
+    for (uint32_t child = watchNodes[node].firstChild; child != WATCH_NODE_NONE; child = next) {
+        next = watchNodes[child].nextSibling; // 해제하면 형제 연결이 끊어지므로 먼저 저장
+        prune_watch_subtree(child, releaseMs);
     }
+    if (!useFanotify) inotify_rm_watch(IeventQueue, watchNodes[node].wd);
+    retire_watch_node(node, releaseMs);
+}
+
+// 해제 시각이 지난 노드를 빈 슬롯으로 반환
+void release_retired_watches(int64_t nowMs) {
+    while (retiredHead < retiredCount && retiredWatches[retiredHead].releaseMs <= nowMs) {
+        uint32_t node = retiredWatches[retiredHead++].node;
+
+        pthread_mutex_lock(&watchTableLock);
+        watch_index_remove(&wdIndex, hash_wd(watchNodes[node].wd), (int)node);
+        watchNodes[node].wd = -1;
+        watchNodes[node].name = NAME_NONE;
+        entry_set_free(&watchNodes[node].entries);
+        watchNodes[node].parent = watchNodeFreeList;
+        watchNodeFreeList = node;
+        pthread_mutex_unlock(&watchTableLock);
+    }
+    if (retiredHead == retiredCount) {
+        retiredHead = retiredCount = 0;
+    }
+}
+
+// 감시 테이블 초기화
+int init_watch_table() {
+    if (watch_index_init(&wdIndex, WATCH_INDEX_INITIAL_CAPACITY) == -1 ||
+        watch_index_init(&childIndex, WATCH_INDEX_INITIAL_CAPACITY) == -1 ||
+        watch_index_init(&nameIndex, WATCH_INDEX_INITIAL_CAPACITY) == -1) {
+        return -1;
+    }
+    return 0;
+}
+
+// 감시 테이블을 비우고 다시 초기화 (fanotify 초기화에 실패해 inotify로 돌아갈 때 등록한 루트 노드를 지움)
+int reset_watch_table() {
+    for (uint32_t node = 0; node < watchNodeCount; ++node) {
+        entry_set_free(&watchNodes[node].entries);
+    }
+    free(watchNodes);
+    watchNodes = NULL;
+    watchNodeCount = watchNodeCapacity = 0;
+    watchNodeFreeList = WATCH_NODE_NONE;
+    retiredHead = retiredCount = 0;
+
+    for (uint32_t i = 0; i < nameChunkCount; ++i) {
+        free(nameChunks[i]);
+    }
+    free(nameChunks);
+    nameChunks = NULL;
+    nameChunkCount = nameChunkCapacity = 0;
+    nameChunkUsed = NAME_CHUNK_SIZE;
+
+    free(wdIndex.entries);
+    free(childIndex.entries);
+    free(nameIndex.entries);
+    return init_watch_table();
+}
+
+int64_t monotonic_ms();
+
+// 사운드 스레드: 사운드 서버 연결을 한 번만 열고, 요청이 오면 최소 간격을 지켜 재생
+void* sound_thread(void* arg) {
+    ca_context *context = NULL;
+    if (ca_context_create(&context) < 0 || ca_context_open(context) < 0) {
+        fprintf(stderr, "Failed to create sound context\n"); // 요청은 계속 받아서 버림
+        if (context) ca_context_destroy(context);
+        context = NULL;
+    }
+
+    int64_t lastPlayMs = INT64_MIN / 2;
+    pthread_mutex_lock(&soundLock);
+    for (;;) {
+        while (!__atomic_load_n(&soundRequested, __ATOMIC_ACQUIRE) && soundRunning) {
+            pthread_cond_wait(&soundReady, &soundLock);
+        }
+        if (!soundRunning) break;
+
+        // 직전 재생 후 최소 간격이 지나지 않았으면 기다림 (그 사이 요청은 soundRequested 하나로 합쳐짐)
+        int64_t waitMs = lastPlayMs + soundIntervalMs - monotonic_ms();
+        if (waitMs > 0) {
+            struct timespec until;
+            clock_gettime(CLOCK_MONOTONIC, &until);
+            until.tv_sec += waitMs / 1000;
+            until.tv_nsec += (waitMs % 1000) * 1000000;
+            if (until.tv_nsec >= 1000000000) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait(&soundReady, &soundLock, &until);
+            continue; // 종료 요청이나 남은 시간 다시 확인
+        }
+
+        __atomic_store_n(&soundRequested, 0, __ATOMIC_RELEASE);
+        lastPlayMs = monotonic_ms();
+        pthread_mutex_unlock(&soundLock);
+
+        // 간단한 이벤트 사운드 재생 (기본 사운드 테마)
+        if (context) {
+            ca_context_play(context, 0,
+                            CA_PROP_EVENT_ID, "message-new-instant",
+                            CA_PROP_EVENT_DESCRIPTION, "File event notification",
+                            NULL);
+        }
+        pthread_mutex_lock(&soundLock);
+    }
+    pthread_mutex_unlock(&soundLock);
+
+    if (context) ca_context_destroy(context);
+    return NULL;
+}
+
+// 사운드 스레드 시작 (실패하면 사운드 없이 계속)
+void start_sound_worker() {
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&soundReady, &attributes);
+    pthread_condattr_destroy(&attributes);
+
+    soundRunning = true;
+    if (pthread_create(&soundThread, NULL, sound_thread, NULL) != 0) {
+        fprintf(stderr, "Error starting sound thread\n");
+        soundRunning = false;
+    }
+}
+
+// 사운드 스레드 종료 (재생 대기 중인 요청은 버림)
+void stop_sound_worker() {
+    if (!soundRunning) return;
+    pthread_mutex_lock(&soundLock);
+    soundRunning = false;
+    pthread_cond_signal(&soundReady);
+    pthread_mutex_unlock(&soundLock);
+    pthread_join(soundThread, NULL);
+}
+
+// 이벤트 사운드 요청 (감시 스레드에서 호출, 재생을 기다리지 않음)
+void event_sound() {
+    if (!soundRunning) return;
+    if (__atomic_exchange_n(&soundRequested, 1, __ATOMIC_ACQ_REL)) return; // 아직 재생하지 않은 요청과 합침
+
+    pthread_mutex_lock(&soundLock);
+    pthread_cond_signal(&soundReady);
+    pthread_mutex_unlock(&soundLock);
+}
+
+void apply_custom_css(GtkWidget *widget, const char *css) {
+    GtkCssProvider *provider = gtk_css_provider_new();
+    gtk_css_provider_load_from_data(provider, css, -1, NULL);
+
+    GtkStyleContext *context = gtk_widget_get_style_context(widget);
+    gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider),
+                                   GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+    g_object_unref(provider);
+}
+
+void show_directory_contents(const char *directory);
+void cancel_directory_contents();
+
+// 목록 작성 스레드가 넘기는 디렉토리 항목 묶음
+typedef struct {
+    uint64_t generation;              // 이 묶음을 만든 요청 번호
+    bool done;                        // 마지막 묶음인지 여부
+    int error;                        // 디렉토리를 열지 못한 경우 errno
+    uint32_t count;                   // 항목 수
+    size_t length;                    // names에 쓴 크기
+    size_t capacity;
+    char* names;                      // NUL로 구분한 항목 이름
+} ContentsChunk;
+
+// 디렉토리 내용 목록 작성 요청
+typedef struct {
+    uint64_t generation;
+    ContentsChunk* chunk;             // 첫 묶음 (요청할 때 할당해 두어 목록 작성 스레드가 항상 마지막 묶음을 보낼 수 있음)
+    char path[];
+} ContentsJob;
+
+// 내용 창 상태 표시 (항목 수, 진행 중/취소 여부)
+void set_contents_status(const char* state) {
+    char subtitle[64];
+    snprintf(subtitle, sizeof(subtitle), "%d entries%s", contentsRows, state);
+    gtk_header_bar_set_subtitle(GTK_HEADER_BAR(contentsHeader), subtitle);
+}
+
+// 묶음을 넘기려고 기다리는 목록 작성 스레드를 깨움
+void signal_contents_flow() {
+    pthread_mutex_lock(&contentsFlowLock);
+    pthread_cond_broadcast(&contentsFlowReady);
+    pthread_mutex_unlock(&contentsFlowLock);
+}
+
+// GTK 메인 스레드에서 묶음을 내용 창에 추가 (취소된 요청의 묶음은 버림)
+gboolean append_contents_chunk(gpointer data) {
+    ContentsChunk* chunk = data;
+    __atomic_sub_fetch(&contentsChunksInFlight, 1, __ATOMIC_RELEASE);
+    signal_contents_flow();
+
+    if (chunk->generation == __atomic_load_n(&contentsGeneration, __ATOMIC_ACQUIRE)) {
+        const char* name = chunk->names;
+        for (uint32_t i = 0; i < chunk->count; ++i) {
+            gtk_list_store_insert_with_values(contentsStore, NULL, -1, 0, name, -1);
+            name += strlen(name) + 1;
+        }
+        contentsRows += (int)chunk->count;
+        if (chunk->done || chunk->error) contentsLoading = false;
+
+        if (chunk->error) {
+            fprintf(stderr, "Error reading directory %s: %s\n", contentsDirectory, strerror(chunk->error));
+            set_contents_status(chunk->error == ENOMEM ? " (incomplete)" : " (cannot open)");
+        }
+        else {
+            set_contents_status(chunk->done ? "" : " (loading)");
+        }
+    }
+
+    free(chunk->names);
+    free(chunk);
+    return FALSE;
+}
+
+// 묶음을 GTK 메인 스레드로 넘기고 새 묶음을 준비 (UI가 밀려 있으면 기다림)
+// 새 묶음을 할당하지 못하면 넘기는 묶음을 마지막 묶음으로 표시 (내용 창이 "loading"으로 남지 않도록)
+ContentsChunk* post_contents_chunk(ContentsChunk* chunk, uint64_t generation) {
+    ContentsChunk* next = chunk->done ? NULL : calloc(1, sizeof(ContentsChunk));
+    if (next) next->generation = generation;
+    else if (!chunk->done) {
+        chunk->done = true;
+        chunk->error = ENOMEM;
+    }
+
+    pthread_mutex_lock(&contentsFlowLock);
+    while (__atomic_load_n(&contentsChunksInFlight, __ATOMIC_ACQUIRE) >= CONTENTS_MAX_CHUNKS_IN_FLIGHT &&
+           __atomic_load_n(&contentsGeneration, __ATOMIC_ACQUIRE) == generation) {
+        pthread_cond_wait(&contentsFlowReady, &contentsFlowLock);
+    }
+    pthread_mutex_unlock(&contentsFlowLock);
+    __atomic_add_fetch(&contentsChunksInFlight, 1, __ATOMIC_RELEASE);
+    g_idle_add(append_contents_chunk, chunk);
+    return next;
+}
+
+// 목록 작성 스레드: 디렉토리를 읽어 CONTENTS_CHUNK_ENTRIES개씩 넘김
+// 다른 디렉토리가 요청되면 (요청 번호가 바뀌면) 바로 멈춤
+void* contents_thread(void* arg) {
+    ContentsJob* job = arg;
+    ContentsChunk* chunk = job->chunk;
+
+    DIR* dir = opendir(job->path);
+    if (!dir) chunk->error = errno;
+
+    struct dirent* entry;
+    while (chunk && dir && (entry = readdir(dir)) != NULL) {
+        if (__atomic_load_n(&contentsGeneration, __ATOMIC_ACQUIRE) != job->generation) break; // 취소됨
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue; // 현재 디렉토리와 부모 디렉토리는 무시
+        }
+
+        size_t nameLength = strlen(entry->d_name);
+        if (chunk->length + nameLength + 2 > chunk->capacity) {
+            size_t capacity = chunk->capacity ? chunk->capacity * 2 : 64 * 1024;
+            char* names = realloc(chunk->names, capacity);
+            if (!names) {
+                chunk->error = ENOMEM; // 읽은 데까지만 보여 줌
+                break;
+            }
+            chunk->names = names;
+            chunk->capacity = capacity;
+        }
+        memcpy(chunk->names + chunk->length, entry->d_name, nameLength);
+        chunk->length += nameLength;
+        if (entry->d_type == DT_DIR) chunk->names[chunk->length++] = '/'; // 디렉토리 표시 (두 번 클릭하면 들어감)
+        chunk->names[chunk->length++] = '\0';
+
+        if (++chunk->count == CONTENTS_CHUNK_ENTRIES) {
+            chunk = post_contents_chunk(chunk, job->generation);
+        }
+    }
+    if (dir) closedir(dir);
+
+    if (chunk) {
+        chunk->done = true;
+        post_contents_chunk(chunk, job->generation);
+    }
+    free(job);
+    return NULL;
+}
+
+// 진행 중인 내용 목록 작성 취소 (이미 받은 항목은 그대로 둠)
+void cancel_directory_contents() {
+    if (!contentsLoading) return;
+    __atomic_add_fetch(&contentsGeneration, 1, __ATOMIC_ACQ_REL);
+    signal_contents_flow(); // 기다리던 목록 작성 스레드가 취소를 알아채고 끝나도록
+    contentsLoading = false;
+    set_contents_status(" (cancelled)");
+}
+
+// 디렉토리 내용을 목록 작성 스레드에서 읽어 보여 줌 (이전 요청은 취소)
+void show_directory_contents(const char *directory) {
+    uint64_t generation = __atomic_add_fetch(&contentsGeneration, 1, __ATOMIC_ACQ_REL);
+    signal_contents_flow();
+
+    gtk_list_store_clear(contentsStore);
+    contentsRows = 0;
+    free(contentsDirectory);
+    contentsDirectory = strdup(directory);
+    gtk_header_bar_set_title(GTK_HEADER_BAR(contentsHeader), directory);
+    contentsLoading = true;
+    set_contents_status(" (loading)");
+
+    size_t length = strlen(directory) + 1;
+    ContentsJob* job = malloc(sizeof(ContentsJob) + length);
+    ContentsChunk* chunk = calloc(1, sizeof(ContentsChunk));
+    if (!job || !chunk) {
+        fprintf(stderr, "Error allocating directory listing for %s\n", directory);
+        contentsLoading = false;
+        set_contents_status(" (out of memory)");
+        free(job);
+        free(chunk);
+        return;
+    }
+    chunk->generation = generation;
+    job->generation = generation;
+    job->chunk = chunk;
+    memcpy(job->path, directory, length);
+
+    pthread_t thread;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, contents_thread, job) != 0) {
+        perror("Error starting directory listing thread");
+        contentsLoading = false;
+        set_contents_status("");
+        free(chunk);
+        free(job);
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// 내용 창에서 디렉토리 항목을 두 번 클릭하거나 Enter를 누르면 그 디렉토리로 들어감
+void on_contents_row_activated(GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column, gpointer data) {
+    GtkTreeIter iter;
+    if (!contentsDirectory || !gtk_tree_model_get_iter(GTK_TREE_MODEL(contentsStore), &iter, path)) return;
+
+    gchar *name = NULL;
+    gtk_tree_model_get(GTK_TREE_MODEL(contentsStore), &iter, 0, &name, -1);
+    size_t nameLength = name ? strlen(name) : 0;
+    if (nameLength > 1 && name[nameLength - 1] == '/') {
+        char childPath[PATH_MAX];
+        snprintf(childPath, sizeof(childPath), "%s/%.*s", contentsDirectory, (int)(nameLength - 1), name);
+        show_directory_contents(childPath);
+    }
+    g_free(name);
+}
+
+// 디렉토리 목록 행 하나 (행을 만들기 전에 감시 테이블에서 복사해 둔 값)
+typedef struct {
+    int wd;
+    bool hasChildren;                 // 하위 디렉토리가 있으면 펼칠 수 있도록 자리 표시 행을 붙임
+    char* name;
+} DirectoryRow;
+
+// 노드의 행 정보를 복사하고 행이 있다고 표시 (watchTableLock을 잡은 상태에서 호출)
+void take_directory_row(uint32_t node, DirectoryRow* row) {
+    row->wd = watchNodes[node].wd;
+    row->hasChildren = watchNodes[node].firstChild != WATCH_NODE_NONE;
+    row->name = strdup(name_string(watchNodes[node].name));
+    watchNodes[node].listed = 1;
+}
+
+// 목록에 행 추가 (parent가 NULL이면 최상위)
+void insert_directory_row(GtkTreeIter* parent, DirectoryRow* row) {
+    GtkTreeIter iter;
+    gtk_tree_store_insert_with_values(directoryStore, &iter, parent, -1, DIRECTORY_COLUMN_NAME, row->name ? row->name : "?",
+                                      DIRECTORY_COLUMN_WD, row->wd, DIRECTORY_COLUMN_BACKGROUND, NULL, -1);
+    GtkTreeIter* stored = g_new(GtkTreeIter, 1);
+    *stored = iter; // 트리 저장소의 iter는 행이 있는 동안 유효
+    g_hash_table_insert(directoryRows, GINT_TO_POINTER(row->wd), stored);
+    if (row->hasChildren) {
+        gtk_tree_store_insert_with_values(directoryStore, NULL, &iter, -1, DIRECTORY_COLUMN_NAME, "", DIRECTORY_COLUMN_WD, -1, -1);
+    }
+    free(row->name);
+}
+
+// 행과 그 아래 행들을 색인에서 지우고 노드의 행 표시를 해제 (행 자체는 호출한 쪽이 지움)
+void forget_directory_rows(GtkTreeIter* iter) {
+    GtkTreeIter child;
+    if (gtk_tree_model_iter_children(GTK_TREE_MODEL(directoryStore), &child, iter)) {
+        do {
+            forget_directory_rows(&child);
+        } while (gtk_tree_model_iter_next(GTK_TREE_MODEL(directoryStore), &child));
+    }
+
+    int wd = -1;
+    gtk_tree_model_get(GTK_TREE_MODEL(directoryStore), iter, DIRECTORY_COLUMN_WD, &wd, -1);
+    if (wd == -1) return; // 자리 표시 행
+
+    g_hash_table_remove(directoryRows, GINT_TO_POINTER(wd));
+    int node = find_watch_by_wd(wd);
+    if (node >= 0) watchNodes[node].listed = 0;
+}
+
+// 행의 하위 행을 모두 지움
+void clear_directory_children(GtkTreeIter* iter) {
+    GtkTreeIter child;
+    pthread_mutex_lock(&watchTableLock);
+    while (gtk_tree_model_iter_children(GTK_TREE_MODEL(directoryStore), &child, iter)) {
+        forget_directory_rows(&child);
+        gtk_tree_store_remove(directoryStore, &child);
+    }
+    pthread_mutex_unlock(&watchTableLock);
+}
+
+// 펼치기 직전: 자리 표시 행을 지우고 바로 아래 디렉토리만 행으로 만듦
+gboolean on_directory_test_expand(GtkTreeView *view, GtkTreeIter *iter, GtkTreePath *path, gpointer data) {
+    int wd = -1;
+    gtk_tree_model_get(GTK_TREE_MODEL(directoryStore), iter, DIRECTORY_COLUMN_WD, &wd, -1);
+    clear_directory_children(iter);
+
+    DirectoryRow* rows = NULL;
+    size_t rowCount = 0;
+    pthread_mutex_lock(&watchTableLock);
+    int node = find_watch_by_wd(wd);
+    if (node >= 0 && !(watchNodes[node].flags & WATCH_NODE_DEAD)) {
+        for (uint32_t child = watchNodes[node].firstChild; child != WATCH_NODE_NONE; child = watchNodes[child].nextSibling) {
+            rowCount++;
+        }
+        rows = rowCount ? malloc(rowCount * sizeof(DirectoryRow)) : NULL; // 하위 디렉토리가 없으면 추가할 행도 없음
+        rowCount = 0;
+        for (uint32_t child = watchNodes[node].firstChild; rows && child != WATCH_NODE_NONE; child = watchNodes[child].nextSibling) {
+            take_directory_row(child, &rows[rowCount++]);
+        }
+    }
+    pthread_mutex_unlock(&watchTableLock);
+
+    // 행 추가는 잠금 밖에서 (그 사이 삭제된 디렉토리는 remove_directory_from_list가 다시 지움)
+    for (size_t i = 0; i < rowCount; ++i) {
+        insert_directory_row(iter, &rows[i]);
+    }
+    free(rows);
+    return FALSE;
+}
+
+// 접으면 하위 행을 지우고 다시 펼칠 수 있도록 자리 표시 행만 남김
+void on_directory_row_collapsed(GtkTreeView *view, GtkTreeIter *iter, GtkTreePath *path, gpointer data) {
+    clear_directory_children(iter);
+    gtk_tree_store_insert_with_values(directoryStore, NULL, iter, -1, DIRECTORY_COLUMN_NAME, "", DIRECTORY_COLUMN_WD, -1, -1);
+}
+
+// 두 번 클릭하거나 Enter를 누르면 강조를 지우고 디렉토리 내용을 보여 줌
+void on_directory_row_activated(GtkTreeView *view, GtkTreePath *path, GtkTreeViewColumn *column, gpointer data) {
+    GtkTreeIter iter;
+    if (!gtk_tree_model_get_iter(GTK_TREE_MODEL(directoryStore), &iter, path)) return;
+
+    int wd = -1;
+    gtk_tree_model_get(GTK_TREE_MODEL(directoryStore), &iter, DIRECTORY_COLUMN_WD, &wd, -1);
+    if (wd == -1) return;
+
+    char directory[PATH_MAX];
+    pthread_mutex_lock(&watchTableLock);
+    int node = find_watch_by_wd(wd);
+    int length = node >= 0 ? watch_build_path((uint32_t)node, directory, sizeof(directory)) : -1;
+    pthread_mutex_unlock(&watchTableLock);
+    if (length < 0) return;
+
+    gtk_tree_store_set(directoryStore, &iter, DIRECTORY_COLUMN_BACKGROUND, NULL, -1);
+    show_directory_contents(directory);
+}
+
+// 다른 디렉토리를 고르면 이전 디렉토리의 목록 작성은 멈춤
+void on_directory_selection_changed(GtkTreeSelection *selection, gpointer data) {
+    cancel_directory_contents();
+}
+
+// 디렉토리 목록에 노드 추가 (부모 행이 펼쳐져 있을 때만 행을 만들고, 접혀 있으면 펼칠 수 있게만 함)
+void add_directory_to_list(int node) {
+    pthread_mutex_lock(&watchTableLock);
+    if (node < 0 || (watchNodes[node].flags & WATCH_NODE_DEAD) || watchNodes[node].listed) {
+        pthread_mutex_unlock(&watchTableLock);
+        return;
+    }
+    uint32_t parent = watchNodes[node].parent;
+    GtkTreeIter* parentIter = NULL;
+    if (parent != WATCH_NODE_NONE) {
+        parentIter = g_hash_table_lookup(directoryRows, GINT_TO_POINTER(watchNodes[parent].wd));
+        if (!parentIter) { // 부모 행도 아직 없음 (조상이 접혀 있음)
+            pthread_mutex_unlock(&watchTableLock);
+            return;
+        }
+    }
+
+    GtkTreePath* parentPath = parentIter ? gtk_tree_model_get_path(GTK_TREE_MODEL(directoryStore), parentIter) : NULL;
+    bool parentExpanded = !parentPath || gtk_tree_view_row_expanded(GTK_TREE_VIEW(directoryTreeView), parentPath);
+    if (parentPath) gtk_tree_path_free(parentPath);
+
+    DirectoryRow row;
+    if (parentExpanded) take_directory_row((uint32_t)node, &row);
+    pthread_mutex_unlock(&watchTableLock);
+
+    if (parentExpanded) {
+        insert_directory_row(parentIter, &row);
+    }
+    else if (!gtk_tree_model_iter_has_child(GTK_TREE_MODEL(directoryStore), parentIter)) {
+        gtk_tree_store_insert_with_values(directoryStore, NULL, parentIter, -1, DIRECTORY_COLUMN_NAME, "", DIRECTORY_COLUMN_WD, -1, -1);
+    }
+}
+
+// GTK 메인 스레드에서 새 디렉토리를 목록에 추가 (그 사이 삭제된 경우 무시)
+gboolean add_directory_to_list_idle(gpointer data) {
+    pthread_mutex_lock(&watchTableLock);
+    int node = find_watch_by_wd(GPOINTER_TO_INT(data));
+    pthread_mutex_unlock(&watchTableLock);
+
+    add_directory_to_list(node);
+    return FALSE;
+}
+
+// 감시 스레드에서 디렉토리 목록 추가를 GTK 메인 스레드로 요청
+void post_directory_added(int wd) {
+    g_idle_add(add_directory_to_list_idle, GINT_TO_POINTER(wd));
+}
+
+// GTK 메인 스레드에서 삭제된 디렉토리의 행과 그 아래 행 제거
+gboolean remove_directory_from_list(gpointer data) {
+    GtkTreeIter* found = g_hash_table_lookup(directoryRows, data);
+    if (!found) return FALSE;
+
+    GtkTreeIter iter = *found; // forget_directory_rows가 색인 항목을 해제하므로 복사
+    pthread_mutex_lock(&watchTableLock);
+    forget_directory_rows(&iter);
+    pthread_mutex_unlock(&watchTableLock);
+    gtk_tree_store_remove(directoryStore, &iter);
+    return FALSE;
+}
+
+// 활동이 있었던 디렉토리와 그 조상 행을 강조 (이미 강조된 조상에서 멈춤)
+void highlight_directory_row(GtkTreeIter* iter) {
+    GtkTreeIter current = *iter;
+    for (;;) {
+        gchar* background = NULL;
+        gtk_tree_model_get(GTK_TREE_MODEL(directoryStore), &current, DIRECTORY_COLUMN_BACKGROUND, &background, -1);
+        bool highlighted = background != NULL;
+        g_free(background);
+        if (highlighted) return;
+
+        gtk_tree_store_set(directoryStore, &current, DIRECTORY_COLUMN_BACKGROUND, DIRECTORY_HIGHLIGHT_COLOR, -1);
+        GtkTreeIter parent;
+        if (!gtk_tree_model_iter_parent(GTK_TREE_MODEL(directoryStore), &parent, &current)) return;
+        current = parent;
+    }
+}
+
+// 로그 파일 초기화 함수
+void init_log_file(const char* path) {
+    LogFd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644); // 로그 파일 열기 (추가 모드)
+    if (LogFd == -1) {
+        perror("Error opening log file"); // 파일 열기 실패 시 오류 메시지 출력
+        exit(EXIT_FAILURE); // 프로그램 종료
+    }
+    printf("Log file initialized at: %s\n", path); // 로그 파일 초기화 완료 메시지 출력
+}
+
+void init_log_ui() {
+    gtk_init(NULL, NULL);
+
+    // 메인 윈도우 생성
+    logWindow = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(logWindow), "File Monitor Logs");
+    gtk_window_set_default_size(GTK_WINDOW(logWindow), 1000, 600);
+
+    // === 상단 영역: 디렉토리 목록 ===
+    directoryHeader = gtk_header_bar_new();
+    gtk_header_bar_set_title(GTK_HEADER_BAR(directoryHeader), "Monitoring Directories");
+    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(directoryHeader), FALSE);
+
+    // 펼친 디렉토리의 하위 행만 만들고, 접으면 지움
+    directoryStore = gtk_tree_store_new(3, G_TYPE_STRING, G_TYPE_INT, G_TYPE_STRING);
+    directoryRows = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    directoryTreeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(directoryStore));
+    GtkCellRenderer *directoryRenderer = gtk_cell_renderer_text_new();
+    GtkTreeViewColumn *directoryColumn = gtk_tree_view_column_new_with_attributes(
+        "Directory", directoryRenderer, "text", DIRECTORY_COLUMN_NAME, "cell-background", DIRECTORY_COLUMN_BACKGROUND, NULL);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(directoryTreeView), directoryColumn);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(directoryTreeView), FALSE);
+    g_signal_connect(directoryTreeView, "test-expand-row", G_CALLBACK(on_directory_test_expand), NULL);
+    g_signal_connect(directoryTreeView, "row-collapsed", G_CALLBACK(on_directory_row_collapsed), NULL);
+    g_signal_connect(directoryTreeView, "row-activated", G_CALLBACK(on_directory_row_activated), NULL);
+    g_signal_connect(gtk_tree_view_get_selection(GTK_TREE_VIEW(directoryTreeView)), "changed",
+                     G_CALLBACK(on_directory_selection_changed), NULL);
+
+    GtkWidget *topScrollWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(topScrollWindow), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(topScrollWindow), directoryTreeView);
+
+    GtkWidget *topFrame = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_box_pack_start(GTK_BOX(topFrame), directoryHeader, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(topFrame), topScrollWindow, TRUE, TRUE, 0);
+
+    // === 오른쪽 영역: 디렉토리 내용 ===
+    contentsHeader = gtk_header_bar_new();
+    gtk_header_bar_set_title(GTK_HEADER_BAR(contentsHeader), "Directory Contents");
+    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(contentsHeader), FALSE);
+
+    // 로그 창과 같이 고정 높이 행으로 보이는 항목만 그림
+    contentsStore = gtk_list_store_new(1, G_TYPE_STRING);
+    contentsTreeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(contentsStore));
+    GtkCellRenderer *contentsRenderer = gtk_cell_renderer_text_new();
+    GtkTreeViewColumn *contentsColumn = gtk_tree_view_column_new_with_attributes("Name", contentsRenderer, "text", 0, NULL);
+    gtk_tree_view_column_set_sizing(contentsColumn, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(contentsColumn, 1000);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(contentsTreeView), contentsColumn);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(contentsTreeView), FALSE);
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(contentsTreeView), TRUE);
+    g_signal_connect(contentsTreeView, "row-activated", G_CALLBACK(on_contents_row_activated), NULL);
+
+    GtkWidget *contentsScrollWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(contentsScrollWindow), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(contentsScrollWindow), contentsTreeView);
+
+    GtkWidget *contentsFrame = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_box_pack_start(GTK_BOX(contentsFrame), contentsHeader, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(contentsFrame), contentsScrollWindow, TRUE, TRUE, 0);
+
+    // === 하단 영역: 로그 창 ===
+    GtkWidget *logHeader = gtk_header_bar_new();
+    gtk_header_bar_set_title(GTK_HEADER_BAR(logHeader), "Event Logs");
+    gtk_header_bar_set_show_close_button(GTK_HEADER_BAR(logHeader), FALSE);
+
+    // 고정 높이 행이라 보이는 행만 그리고, 행 수는 logViewCapacity로 제한
+    logStore = gtk_list_store_new(1, G_TYPE_STRING);
+    logTreeView = gtk_tree_view_new_with_model(GTK_TREE_MODEL(logStore));
+    GtkCellRenderer *logRenderer = gtk_cell_renderer_text_new();
+    GtkTreeViewColumn *logColumn = gtk_tree_view_column_new_with_attributes("Event", logRenderer, "text", 0, NULL);
+    gtk_tree_view_column_set_sizing(logColumn, GTK_TREE_VIEW_COLUMN_FIXED);
+    gtk_tree_view_column_set_fixed_width(logColumn, 2000);
+    gtk_tree_view_append_column(GTK_TREE_VIEW(logTreeView), logColumn);
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(logTreeView), FALSE);
+    gtk_tree_view_set_fixed_height_mode(GTK_TREE_VIEW(logTreeView), TRUE);
+
+    GtkWidget *logScrollWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(logScrollWindow), GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(logScrollWindow), logTreeView);
+    logScrollAdjustment = gtk_scrolled_window_get_vadjustment(GTK_SCROLLED_WINDOW(logScrollWindow));
+
+    GtkWidget *bottomFrame = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    gtk_box_pack_start(GTK_BOX(bottomFrame), logHeader, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(bottomFrame), logScrollWindow, TRUE, TRUE, 0);
+
+    // === 전체 레이아웃 ===
+    GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 5); // 상단+오른쪽 수평 박스
+    gtk_box_pack_start(GTK_BOX(hbox), topFrame, TRUE, TRUE, 0);   // 상단 영역
+    gtk_box_pack_start(GTK_BOX(hbox), contentsFrame, TRUE, TRUE, 0); // 오른쪽 영역
+
+    GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5); // 수직 레이아웃
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, TRUE, TRUE, 0);     // 상단+오른쪽
+    gtk_box_pack_end(GTK_BOX(vbox), bottomFrame, TRUE, TRUE, 0); // 하단 로그
+
+    gtk_container_add(GTK_CONTAINER(logWindow), vbox);
+
+    // 창 닫기 이벤트 처리
+    g_signal_connect(logWindow, "destroy", G_CALLBACK(gtk_main_quit), NULL);
+
+    gtk_widget_show_all(logWindow);
+}
+
+// 링 버퍼 초기화 (capacity는 2의 거듭제곱이어야 함)
+int spsc_ring_init(SpscRing* ring, size_t capacity, size_t recordSize) {
+    memset(ring, 0, sizeof(*ring));
+    ring->capacity = capacity;
+    ring->recordSize = (recordSize + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    if (posix_memalign((void**)&ring->slots, CACHE_LINE_SIZE, ring->capacity * ring->recordSize) != 0) {
+        ring->slots = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+// 생산자: 다음 슬롯 확보 (가득 찬 경우 누락으로 기록하고 NULL 반환)
+void* spsc_ring_reserve(SpscRing* ring) {
+    size_t tail = ring->tail;
+    if (tail - ring->cachedHead >= ring->capacity) {
+        ring->cachedHead = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail - ring->cachedHead >= ring->capacity) {
+            __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    }
+    return ring->slots + (tail & (ring->capacity - 1)) * ring->recordSize;
+}
+
+// 생산자: 확보한 슬롯을 소비자에게 공개
+void spsc_ring_commit(SpscRing* ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_RELEASE);
+}
+
+// 소비자: 가장 오래된 레코드 확인 (비어 있으면 NULL)
+const void* spsc_ring_front(SpscRing* ring) {
+    size_t head = ring->head;
+    if (head == ring->cachedTail) {
+        ring->cachedTail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head == ring->cachedTail) {
+            return NULL;
+        }
+    }
+    return ring->slots + (head & (ring->capacity - 1)) * ring->recordSize;
+}
+
+// 소비자: 확인한 레코드를 반환하여 슬롯 재사용 허용
+void spsc_ring_pop(SpscRing* ring) {
+    __atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+}
+
+// 소비자: 링이 비어 있는지 확인
+bool spsc_ring_empty(SpscRing* ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_RELAXED) == __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+// 이벤트 종류를 문자열로 변환
+const char* event_kind_name(uint32_t mask) {
+    if ((mask & IN_MOVED_FROM) && (mask & IN_MOVED_TO)) return "renamed";
+    if (mask & IN_MOVED_FROM) return "moved out";
+    if (mask & IN_MOVED_TO) return "moved in";
+    if ((mask & IN_CREATE) && (mask & IN_DELETE)) return "created and deleted";
+    if (mask & IN_CREATE) return "created";
+    if (mask & IN_DELETE) return "deleted";
+    if (mask & IN_MODIFY) return "modified";
+    if (mask & IN_MOVE_SELF) return "moved";
+    return "changed";
+}
+
+// 나노초 시각을 "YYYY-MM-DD HH:MM:SS.mmm"로 변환 (localtime_r은 초가 바뀔 때만 호출)
+void format_timestamp(int64_t timeNs, char* buffer) {
+    time_t second = (time_t)(timeNs / 1000000000);
+    if (second != timestampCache.second) {
+        struct tm localTime;
+        strftime(timestampCache.text, sizeof(timestampCache.text), "%Y-%m-%d %H:%M:%S", localtime_r(&second, &localTime));
+        timestampCache.second = second;
+    }
+
+    memcpy(buffer, timestampCache.text, 19);
+    int milliseconds = (int)((timeNs % 1000000000) / 1000000);
+    buffer[19] = '.';
+    buffer[20] = (char)('0' + milliseconds / 100);
+    buffer[21] = (char)('0' + milliseconds / 10 % 10);
+    buffer[22] = (char)('0' + milliseconds % 10);
+    buffer[23] = '\0';
+}
+
+// 이벤트 레코드를 사람이 읽을 수 있는 메시지로 변환
+int format_event_message(const EventRecord* record, char* buffer, size_t bufferSize) {
+    char eventTime[EVENT_TIMESTAMP_LENGTH + 1]; // 이벤트 발생 시간 저장
+    format_timestamp(record->eventTimeNs, eventTime);
+
+    if (record->mask & IN_Q_OVERFLOW) { // 큐 오버플로 알림은 경로 대신 설명을 담고 있음
+        return snprintf(buffer, bufferSize, "[%s] Event queue overflow: %s", eventTime, record->path);
+    }
+    if (record->oldPathOffset > 0) {
+        return snprintf(buffer, bufferSize, "[%s] File %s: %s from %s", eventTime, record->path,
+                        event_kind_name(record->mask), record->path + record->oldPathOffset);
+    }
+    if (record->count > 1) {
+        return snprintf(buffer, bufferSize, "[%s] File %s: %s (%u events)", eventTime, record->path,
+                        event_kind_name(record->mask), record->count);
+    }
+    return snprintf(buffer, bufferSize, "[%s] File %s: %s", eventTime, record->path, event_kind_name(record->mask));
+}
+
+// 로그 창 끝에 한 줄 추가 (가득 차면 가장 오래된 줄을 지움)
+void append_log_row(const char* text) {
+    if (logStoreRows >= logViewCapacity) {
+        GtkTreeIter first;
+        if (gtk_tree_model_get_iter_first(GTK_TREE_MODEL(logStore), &first)) {
+            gtk_list_store_remove(logStore, &first);
+            logStoreRows--;
+        }
+    }
+    gtk_list_store_insert_with_values(logStore, NULL, -1, 0, text, -1);
+    logStoreRows++;
+}
+
+int64_t monotonic_ms();
+
+// 감시 스레드가 모은 디렉토리 강조를 한 번에 적용 (디렉토리마다 한 번)
+void apply_highlights() {
+    pthread_mutex_lock(&highlightLock);
+    HighlightRequest* batch = highlightQueue;
+    size_t count = highlightCount;
+    size_t capacity = highlightCapacity;
+    highlightQueue = highlightSpare;
+    highlightCapacity = highlightSpareCapacity;
+    highlightCount = 0;
+    pthread_mutex_unlock(&highlightLock);
+
+    pthread_mutex_lock(&watchTableLock);
+    for (size_t i = 0; i < count; ++i) {
+        if (batch[i].node >= watchNodeCount) continue;
+        WatchNode* node = &watchNodes[batch[i].node];
+        if (node->wd != batch[i].wd || (node->flags & WATCH_NODE_DEAD)) continue;
+        __atomic_store_n(&node->highlightPending, 0, __ATOMIC_RELEASE);
+
+        // 행이 없으면 (조상이 접혀 있으면) 행이 있는 가장 가까운 조상을 강조
+        uint32_t current = batch[i].node;
+        while (current != WATCH_NODE_NONE && !watchNodes[current].listed) {
+            current = watchNodes[current].parent;
+        }
+        GtkTreeIter* iter = current != WATCH_NODE_NONE ?
+                            g_hash_table_lookup(directoryRows, GINT_TO_POINTER(watchNodes[current].wd)) : NULL;
+        if (iter) highlight_directory_row(iter);
+    }
+    pthread_mutex_unlock(&watchTableLock);
+
+    highlightSpare = batch;
+    highlightSpareCapacity = capacity;
+}
+
+// UI 프레임: 그 사이 쌓인 이벤트와 강조를 한 번에 반영 (최대 약 30 Hz)
+gboolean update_ui(gpointer data) {
+    // 먼저 예약을 풀어서 처리 중에 들어온 이벤트는 다음 프레임을 예약하게 함
+    __atomic_store_n(&uiFrameScheduled, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&lastUiFrameMs, monotonic_ms(), __ATOMIC_RELAXED);
+
+    // 맨 아래를 보고 있을 때만 새 줄을 따라감 (위로 스크롤해 둔 위치는 유지)
+    bool followTail = gtk_adjustment_get_value(logScrollAdjustment) + gtk_adjustment_get_page_size(logScrollAdjustment) >=
+                      gtk_adjustment_get_upper(logScrollAdjustment) - 1;
+
+    // 로그 창에 남지 못할 오래된 이벤트는 메시지로 만들지 않고 건너뜀
+    size_t backlog = __atomic_load_n(&uiRing.tail, __ATOMIC_ACQUIRE) - uiRing.head;
+    size_t skipped = backlog > (size_t)logViewCapacity ? backlog - (size_t)logViewCapacity : 0;
+    for (size_t i = 0; i < skipped; ++i) {
+        spsc_ring_pop(&uiRing);
+    }
+
+    int drained = 0;
+    const EventRecord* record;
+    while ((size_t)drained + skipped < backlog && (record = spsc_ring_front(&uiRing)) != NULL) {
+        char eventMessage[EVENT_PATH_MAX + 128];
+        int length = format_event_message(record, eventMessage, sizeof(eventMessage));
+        spsc_ring_pop(&uiRing);
+        drained++;
+
+        if (length >= 0) append_log_row(eventMessage);
+    }
+
+    // 링이 가득 차서 버려진 이벤트가 있으면 한 줄로 알림
+    uint64_t dropped = __atomic_load_n(&uiRing.dropped, __ATOMIC_RELAXED);
+    if (dropped != uiDroppedReported) {
+        char notice[64];
+        snprintf(notice, sizeof(notice), "[%llu events dropped: UI queue full]", (unsigned long long)(dropped - uiDroppedReported));
+        append_log_row(notice);
+        uiDroppedReported = dropped;
+    }
+
+    if (followTail && drained > 0) {
+        GtkTreePath *lastPath = gtk_tree_path_new_from_indices(logStoreRows - 1, -1);
+        gtk_tree_view_scroll_to_cell(GTK_TREE_VIEW(logTreeView), lastPath, NULL, FALSE, 0, 0);
+        gtk_tree_path_free(lastPath);
+    }
+
+    apply_highlights();
+    return FALSE; // 다음 프레임은 새 이벤트가 올 때 예약
+}
+
+// 다음 UI 프레임 예약 (감시 스레드에서 호출, 이미 예약되어 있으면 아무것도 하지 않음)
+void request_ui_frame() {
+    if (__atomic_exchange_n(&uiFrameScheduled, 1, __ATOMIC_SEQ_CST)) return;
+
+    int64_t waitMs = __atomic_load_n(&lastUiFrameMs, __ATOMIC_RELAXED) + UI_FRAME_INTERVAL_MS - monotonic_ms();
+    g_timeout_add(waitMs > 0 ? (guint)waitMs : 0, update_ui, NULL);
+}
+
+// 디렉토리 강조를 다음 UI 프레임에 요청 (프레임마다 디렉토리당 한 번만 쌓음)
+void queue_highlight(int node) {
+    if (__atomic_exchange_n(&watchNodes[node].highlightPending, 1, __ATOMIC_ACQ_REL)) return;
+
+    pthread_mutex_lock(&highlightLock);
+    if (highlightCount == highlightCapacity) {
+        size_t capacity = highlightCapacity ? highlightCapacity * 2 : 64;
+        HighlightRequest* queue = realloc(highlightQueue, capacity * sizeof(HighlightRequest));
+        if (!queue) {
+            pthread_mutex_unlock(&highlightLock);
+            __atomic_store_n(&watchNodes[node].highlightPending, 0, __ATOMIC_RELEASE);
+            return;
+        }
+        highlightQueue = queue;
+        highlightCapacity = capacity;
+    }
+    highlightQueue[highlightCount].node = (uint32_t)node;
+    highlightQueue[highlightCount].wd = watchNodes[node].wd;
+    highlightCount++;
+    pthread_mutex_unlock(&highlightLock);
+
+    request_ui_frame();
+}
+
+// 버퍼 조각을 writev로 한꺼번에 기록 (부분 기록은 이어서 씀)
+int write_log_chunks(int fd, struct iovec* chunks, int chunkCount) {
+    while (chunkCount > 0) {
+        ssize_t written = writev(fd, chunks, chunkCount);
+        if (written == -1) {
+            if (errno == EINTR) continue;
+            perror("Error writing log file");
+            return -1;
+        }
+        while (chunkCount > 0 && (size_t)written >= chunks->iov_len) {
+            written -= (ssize_t)chunks->iov_len;
+            chunks++;
+            chunkCount--;
+        }
+        if (chunkCount > 0) {
+            chunks->iov_base = (char*)chunks->iov_base + written;
+            chunks->iov_len -= (size_t)written;
+        }
+    }
+    return 0;
+}
+
+// 버퍼 하나를 끝까지 기록
+int write_log_buffer(int fd, const void* buffer, size_t length) {
+    struct iovec chunk = { (void*)buffer, length };
+    return length > 0 ? write_log_chunks(fd, &chunk, 1) : 0;
+}
+
+// 문자열 ID의 경로
+const char* journal_string(uint32_t id) {
+    return ((const JournalString*)(journalStrings + (size_t)id * 4))->text;
+}
+
+// 경로 중복 제거 표에 문자열 ID 추가 (부하율 50%를 넘으면 두 배로 확장)
+int journal_slot_insert(uint32_t id, uint32_t hash) {
+    if ((journalStringSlotUsed + 1) * 2 > journalStringSlotCapacity) {
+        size_t capacity = journalStringSlotCapacity ? journalStringSlotCapacity * 2 : JOURNAL_STRING_SLOTS_INITIAL;
+        JournalStringSlot* slots = calloc(capacity, sizeof(JournalStringSlot));
+        if (!slots) return -1;
+        for (size_t i = 0; i < journalStringSlotCapacity; ++i) {
+            if (journalStringSlots[i].id == JOURNAL_PATH_NONE) continue;
+            size_t j = mix32(journalStringSlots[i].hash) & (capacity - 1);
+            while (slots[j].id != JOURNAL_PATH_NONE) j = (j + 1) & (capacity - 1);
+            slots[j] = journalStringSlots[i];
+        }
+        free(journalStringSlots);
+        journalStringSlots = slots;
+        journalStringSlotCapacity = capacity;
+    }
+
+    size_t mask = journalStringSlotCapacity - 1;
+    size_t i = mix32(hash) & mask;
+    while (journalStringSlots[i].id != JOURNAL_PATH_NONE) i = (i + 1) & mask;
+    journalStringSlots[i].id = id;
+    journalStringSlots[i].hash = hash;
+    journalStringSlotUsed++;
+    return 0;
+}
+
+// 경로를 문자열 표에 넣고 ID 반환 (이미 있으면 기존 ID, 실패 시 JOURNAL_PATH_NONE)
+uint32_t journal_intern_path(const char* path, uint64_t pathHash) {
+    uint32_t hash = (uint32_t)pathHash;
+    if (journalStringSlotCapacity > 0) {
+        size_t mask = journalStringSlotCapacity - 1;
+        for (size_t i = mix32(hash) & mask; journalStringSlots[i].id != JOURNAL_PATH_NONE; i = (i + 1) & mask) {
+            if (journalStringSlots[i].hash == hash && strcmp(journal_string(journalStringSlots[i].id), path) == 0) {
+                return journalStringSlots[i].id;
+            }
+        }
+    }
+
+    size_t length = strlen(path);
+    size_t entrySize = (sizeof(JournalString) + length + 1 + 3) & ~(size_t)3;
+    if (journalStringSize + entrySize > (size_t)UINT32_MAX * 4) return JOURNAL_PATH_NONE; // 문자열 ID 범위 초과
+    if (journalStringSize + entrySize > journalStringCapacity) {
+        size_t capacity = journalStringCapacity * 2;
+        while (capacity < journalStringSize + entrySize) capacity *= 2;
+        char* strings = realloc(journalStrings, capacity);
+        if (!strings) return JOURNAL_PATH_NONE;
+        journalStrings = strings;
+        journalStringCapacity = capacity;
+    }
+
+    uint32_t id = (uint32_t)(journalStringSize / 4);
+    JournalString* entry = (JournalString*)(journalStrings + journalStringSize);
+    memset(entry, 0, entrySize);
+    entry->length = (uint32_t)length;
+    memcpy(entry->text, path, length);
+    if (journal_slot_insert(id, hash) == -1) return JOURNAL_PATH_NONE;
+    journalStringSize += entrySize;
+    return id;
+}
+
+// 문자열 표, 레코드 순서로 아직 쓰지 않은 내용을 기록 (레코드가 가리키는 경로가 항상 먼저 기록됨)
+void journal_flush() {
+    write_log_buffer(JournalStringFd, journalStrings + journalStringFlushed, journalStringSize - journalStringFlushed);
+    journalStringFlushed = journalStringSize;
+    write_log_buffer(JournalFd, journalPending, (size_t)journalPendingCount * sizeof(JournalRecord));
+    journalPendingCount = 0;
+}
+
+// 레코드를 현재 색인 블록에 반영하고, 블록이 차면 색인 파일에 기록
+void journal_index_record(const JournalRecord* record) {
+    if (journalBlockRecords == 0) {
+        memset(&journalBlock, 0, sizeof(journalBlock));
+        journalBlock.firstSequence = record->sequence;
+        journalBlock.minTimeNs = INT64_MAX;
+        journalBlock.maxTimeNs = INT64_MIN;
+    }
+    if (record->timeNs < journalBlock.minTimeNs) journalBlock.minTimeNs = record->timeNs;
+    if (record->timeNs > journalBlock.maxTimeNs) journalBlock.maxTimeNs = record->timeNs;
+    if (record->pathId != JOURNAL_PATH_NONE) {
+        journal_bloom_add(journalBlock.pathBloom, journal_path_hash(journal_string(record->pathId)));
+    }
+    if (record->oldPathId != JOURNAL_PATH_NONE) {
+        journal_bloom_add(journalBlock.pathBloom, journal_path_hash(journal_string(record->oldPathId)));
+    }
+
+    if (++journalBlockRecords == JOURNAL_BLOCK_RECORDS) {
+        journal_flush(); // 색인이 가리키는 레코드를 먼저 기록
+        write_log_buffer(JournalIndexFd, &journalBlock, sizeof(journalBlock));
+        journalBlockRecords = 0;
+    }
+}
+
+// 이벤트 레코드를 저널에 추가
+void journal_append(const EventRecord* event) {
+    JournalRecord* record = &journalPending[journalPendingCount++];
+    record->sequence = journalSequence++;
+    record->timeNs = event->eventTimeNs;
+    record->mask = event->mask;
+    record->count = event->count;
+    record->pathId = journal_intern_path(event->path, journal_path_hash(event->path));
+    record->oldPathId = JOURNAL_PATH_NONE;
+    if (event->oldPathOffset > 0) {
+        const char* oldPath = event->path + event->oldPathOffset;
+        record->oldPathId = journal_intern_path(oldPath, journal_path_hash(oldPath));
+    }
+
+    JournalRecord indexed = *record;
+    if (journalPendingCount == JOURNAL_WRITE_BATCH) journal_flush();
+    journal_index_record(&indexed);
+}
+
+// 저널 파일 하나를 열고 헤더를 확인하거나 새로 기록 (헤더 뒤 내용 크기 반환, 실패 시 -1)
+off_t open_journal_file(const char* path, uint32_t magic, uint32_t entrySize, int* fd) {
+    *fd = open(path, O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (*fd == -1) {
+        fprintf(stderr, "Error opening journal file %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat fileStat;
+    if (fstat(*fd, &fileStat) == -1) return -1;
+    if (fileStat.st_size < (off_t)sizeof(JournalHeader)) { // 새 파일 (또는 헤더도 못 쓴 파일)
+        JournalHeader header = { magic, JOURNAL_VERSION, entrySize, 0 };
+        if (ftruncate(*fd, 0) == -1 || write_log_buffer(*fd, &header, sizeof(header)) == -1) return -1;
+        return 0;
+    }
+
+    JournalHeader header;
+    if (pread(*fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        header.magic != magic || header.version != JOURNAL_VERSION || header.entrySize != entrySize) {
+        fprintf(stderr, "Incompatible journal file %s\n", path);
+        return -1;
+    }
+    return fileStat.st_size - (off_t)sizeof(JournalHeader);
+}
+
+// 저널 열기: 비정상 종료로 잘린 끝부분을 정리하고 중복 제거 표와 현재 색인 블록을 복원 (실패 시 -1)
+int open_journal(const char* path) {
+    char stringPath[520];
+    char indexPath[520];
+    snprintf(stringPath, sizeof(stringPath), "%s.strings", path);
+    snprintf(indexPath, sizeof(indexPath), "%s.index", path);
+
+    off_t recordBytes = open_journal_file(path, JOURNAL_RECORD_MAGIC, sizeof(JournalRecord), &JournalFd);
+    off_t stringBytes = recordBytes < 0 ? -1 : open_journal_file(stringPath, JOURNAL_STRING_MAGIC, 0, &JournalStringFd);
+    off_t indexBytes = stringBytes < 0 ? -1 : open_journal_file(indexPath, JOURNAL_INDEX_MAGIC, sizeof(JournalIndexBlock), &JournalIndexFd);
+    if (indexBytes < 0) return -1;
+
+    // 문자열 표를 메모리로 읽고 끝까지 온전한 항목만 남김
+    journalStringCapacity = 64 * 1024;
+    while (journalStringCapacity < sizeof(JournalHeader) + (size_t)stringBytes) journalStringCapacity *= 2;
+    journalStrings = malloc(journalStringCapacity);
+    if (!journalStrings || pread(JournalStringFd, journalStrings, sizeof(JournalHeader) + (size_t)stringBytes, 0) !=
+        (ssize_t)(sizeof(JournalHeader) + (size_t)stringBytes)) {
+        fprintf(stderr, "Error reading journal strings %s\n", stringPath);
+        return -1;
+    }
+    journalStringSize = sizeof(JournalHeader);
+    size_t stringEnd = sizeof(JournalHeader) + (size_t)stringBytes;
+    while (journalStringSize + sizeof(JournalString) <= stringEnd) {
+        const JournalString* entry = (const JournalString*)(journalStrings + journalStringSize);
+        size_t entrySize = (sizeof(JournalString) + entry->length + 1 + 3) & ~(size_t)3;
+        if (journalStringSize + entrySize > stringEnd || entry->text[entry->length] != '\0') break;
+        if (journal_slot_insert((uint32_t)(journalStringSize / 4), (uint32_t)journal_path_hash(entry->text)) == -1) return -1;
+        journalStringSize += entrySize;
+    }
+    journalStringFlushed = journalStringSize;
+
+    // 레코드는 통째로 남은 것까지만, 경로가 잘려 나간 레코드도 버림
+    uint64_t recordCount = (uint64_t)recordBytes / sizeof(JournalRecord);
+    while (recordCount > 0) {
+        JournalRecord last;
+        off_t offset = (off_t)sizeof(JournalHeader) + (off_t)((recordCount - 1) * sizeof(JournalRecord));
+        if (pread(JournalFd, &last, sizeof(last), offset) != (ssize_t)sizeof(last)) return -1;
+        if ((size_t)last.pathId * 4 < journalStringSize && (size_t)last.oldPathId * 4 < journalStringSize) break;
+        recordCount--;
+    }
+
+    // 색인은 온전한 블록 중 레코드가 남아 있는 것까지만 유지
+    uint64_t indexBlocks = (uint64_t)indexBytes / sizeof(JournalIndexBlock);
+    if (indexBlocks > recordCount / JOURNAL_BLOCK_RECORDS) indexBlocks = recordCount / JOURNAL_BLOCK_RECORDS;
+
+    if (ftruncate(JournalStringFd, (off_t)journalStringSize) == -1 ||
+        ftruncate(JournalFd, (off_t)sizeof(JournalHeader) + (off_t)(recordCount * sizeof(JournalRecord))) == -1 ||
+        ftruncate(JournalIndexFd, (off_t)sizeof(JournalHeader) + (off_t)(indexBlocks * sizeof(JournalIndexBlock))) == -1) {
+        perror("Error truncating journal");
+        return -1;
+    }
+
+    // 색인되지 않은 레코드로 빠진 색인 블록과 현재 블록을 다시 만듦
+    journalSequence = indexBlocks * JOURNAL_BLOCK_RECORDS;
+    while (journalSequence < recordCount) {
+        JournalRecord records[256];
+        size_t count = recordCount - journalSequence < 256 ? (size_t)(recordCount - journalSequence) : 256;
+        off_t offset = (off_t)sizeof(JournalHeader) + (off_t)(journalSequence * sizeof(JournalRecord));
+        if (pread(JournalFd, records, count * sizeof(JournalRecord), offset) != (ssize_t)(count * sizeof(JournalRecord))) return -1;
+        for (size_t i = 0; i < count; ++i) {
+            journal_index_record(&records[i]);
+        }
+        journalSequence += count;
+    }
+
+    printf("Journal opened at: %s (%llu records)\n", path, (unsigned long long)journalSequence);
+    return 0;
+}
+
+// 저널 파일을 디스크에 반영 (문자열 표, 레코드, 색인 순서)
+void sync_journal() {
+    if (fdatasync(JournalStringFd) == -1 || fdatasync(JournalFd) == -1 || fdatasync(JournalIndexFd) == -1) {
+        perror("Error syncing journal");
+    }
+}
+
+// 로그 링에 쌓인 이벤트를 버퍼에 모아 기록 (기록한 레코드 수 반환)
+size_t drain_log_ring(char* buffers, uint64_t* droppedReported) {
+    struct iovec chunks[LOG_WRITE_CHUNKS];
+    int chunkCount = 0;
+    size_t used = 0; // 현재 조각에서 사용한 바이트 수
+    size_t drained = 0;
+
+    const EventRecord* record;
+    for (;;) {
+        record = spsc_ring_front(&logRing);
+        char* chunk = buffers + (size_t)chunkCount * LOG_WRITE_CHUNK_SIZE;
+
+        // 현재 조각에 최대 길이의 줄이 들어가지 않으면 다음 조각으로, 조각이 다 차면 기록
+        if (!record || LOG_WRITE_CHUNK_SIZE - used < EVENT_PATH_MAX + 256) {
+            if (used > 0) {
+                chunks[chunkCount].iov_base = chunk;
+                chunks[chunkCount].iov_len = used;
+                chunkCount++;
+                used = 0;
+            }
+            if (!record || chunkCount == LOG_WRITE_CHUNKS) {
+                for (int i = 0; i < chunkCount; ++i) logFileSize += (off_t)chunks[i].iov_len;
+                if (chunkCount > 0 && echoEvents) { // 기록하면서 iovec이 바뀌므로 복사본으로 출력
+                    struct iovec echo[LOG_WRITE_CHUNKS];
+                    memcpy(echo, chunks, (size_t)chunkCount * sizeof(struct iovec));
+                    if (write_log_chunks(STDOUT_FILENO, echo, chunkCount) == -1) echoEvents = false; // 출력이 닫혔으면 그만 씀
+                }
+                if (chunkCount > 0) write_log_chunks(LogFd, chunks, chunkCount);
+                chunkCount = 0;
+                if (!record) {
+                    if (JournalFd != -1) journal_flush();
+                    break;
+                }
+            }
+            chunk = buffers + (size_t)chunkCount * LOG_WRITE_CHUNK_SIZE;
+        }
+
+        // 링이 가득 차서 버려진 이벤트가 있으면 로그에도 한 줄로 남김
+        uint64_t dropped = __atomic_load_n(&logRing.dropped, __ATOMIC_RELAXED);
+        if (dropped != *droppedReported) {
+            used += (size_t)snprintf(chunk + used, LOG_WRITE_CHUNK_SIZE - used, "[%llu events dropped: log queue full]\n",
+                                     (unsigned long long)(dropped - *droppedReported));
+            *droppedReported = dropped;
+        }
+
+        if (JournalFd != -1) journal_append(record);
+
+        int length = snprintf(chunk + used, LOG_WRITE_CHUNK_SIZE - used, "Event: ");
+        int message = format_event_message(record, chunk + used + length, LOG_WRITE_CHUNK_SIZE - used - (size_t)length - 1);
+        spsc_ring_pop(&logRing);
+        drained++;
+        if (message < 0) continue;
+
+        size_t lineLength = (size_t)length + (size_t)message;
+        if (used + lineLength >= LOG_WRITE_CHUNK_SIZE - 1) lineLength = LOG_WRITE_CHUNK_SIZE - 2 - used; // 잘린 줄
+        used += lineLength;
+        chunk[used++] = '\n';
+    }
+    return drained;
+}
+
+// 교체된 로그 조각을 압축 큐에 넣음
+void queue_log_compression(const char* path) {
+    size_t length = strlen(path) + 1;
+    LogSegment* segment = malloc(sizeof(LogSegment) + length);
+    if (!segment) {
+        fprintf(stderr, "Error queueing log segment %s for compression\n", path);
+        return;
+    }
+    segment->next = NULL;
+    memcpy(segment->path, path, length);
+
+    pthread_mutex_lock(&compressLock);
+    if (compressQueueTail) compressQueueTail->next = segment;
+    else compressQueueHead = segment;
+    compressQueueTail = segment;
+    pthread_cond_signal(&compressReady);
+    pthread_mutex_unlock(&compressLock);
+}
+
+// 로그 파일을 조각 이름으로 바꾸고 새 파일을 열어 이어서 기록 (로그 기록 스레드에서 호출)
+void rotate_log_file(time_t now) {
+    char stamp[32];
+    struct tm localTime;
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime_r(&now, &localTime));
+
+    char segmentPath[600];
+    snprintf(segmentPath, sizeof(segmentPath), "%s.%s", logFilePath, stamp);
+    for (int suffix = 1; access(segmentPath, F_OK) == 0; ++suffix) { // 같은 초에 두 번 교체된 경우
+        snprintf(segmentPath, sizeof(segmentPath), "%s.%s.%d", logFilePath, stamp, suffix);
+    }
+
+    if (rename(logFilePath, segmentPath) == -1) {
+        perror("Error rotating log file");
+        logSegmentStart = now; // 다음 주기에 다시 시도
+        return;
+    }
+
+    int fd = open(logFilePath, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        perror("Error reopening log file"); // 이름이 바뀐 이전 파일에 계속 기록
+        logSegmentStart = now;
+        return;
+    }
+    if (fdatasync(LogFd) == -1) perror("Error syncing log file");
+    close(LogFd);
+    LogFd = fd;
+    logFileSize = 0;
+    logSegmentStart = now;
+
+    queue_log_compression(segmentPath);
+}
+
+// 크기나 시간 기준을 넘었으면 로그 파일 교체
+void rotate_log_if_needed() {
+    time_t now = time(NULL);
+    if (logFileSize == 0) return; // 빈 파일은 교체하지 않음
+    if ((logRotateSizeMb > 0 && logFileSize >= (off_t)logRotateSizeMb * 1024 * 1024) ||
+        (logRotateHours > 0 && now - logSegmentStart >= (time_t)logRotateHours * 3600)) {
+        rotate_log_file(now);
+    }
+}
+
+// 로그 줄의 시각을 유닉스 시각으로 변환 (실패 시 0)
+time_t parse_log_timestamp(const char* text) {
+    struct tm localTime;
+    memset(&localTime, 0, sizeof(localTime));
+    if (!strptime(text, "%Y-%m-%d %H:%M:%S", &localTime)) return 0;
+    localTime.tm_isdst = -1;
+    return mktime(&localTime);
+}
+
+// 압축이 끝난 조각을 조각 색인에 추가하고, 보관 개수를 넘은 오래된 조각은 삭제
+void update_segment_index(const char* segmentName, time_t firstTime, time_t lastTime) {
+    char indexPath[600];
+    char tempPath[620];
+    snprintf(indexPath, sizeof(indexPath), "%s.segments", logFilePath);
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", indexPath);
+
+    // 한 줄에 "첫 이벤트 시각 마지막 이벤트 시각 파일 이름" (유닉스 초)
+    FILE* index = fopen(indexPath, "a+e");
+    if (!index) {
+        perror("Error opening log segment index");
+        return;
+    }
+    fprintf(index, "%lld %lld %s\n", (long long)firstTime, (long long)lastTime, segmentName);
+    if (logKeepSegments <= 0) {
+        fclose(index);
+        return;
+    }
+
+    rewind(index);
+    char line[PATH_MAX + 64];
+    int lineCount = 0;
+    while (fgets(line, sizeof(line), index)) lineCount++;
+    if (lineCount <= logKeepSegments) {
+        fclose(index);
+        return;
+    }
+
+    // 오래된 조각을 지우고 남은 줄로 색인을 다시 씀 (rename으로 교체하여 읽는 쪽은 항상 온전한 색인을 봄)
+    char directory[600];
+    snprintf(directory, sizeof(directory), "%s", logFilePath);
+    char* slash = strrchr(directory, '/');
+    if (slash) slash[1] = '\0';
+    else directory[0] = '\0';
+
+    FILE* temp = fopen(tempPath, "we");
+    if (!temp) {
+        perror("Error rewriting log segment index");
+        fclose(index);
+        return;
+    }
+    rewind(index);
+    for (int i = 0; fgets(line, sizeof(line), index); ++i) {
+        if (i >= lineCount - logKeepSegments) {
+            fputs(line, temp);
+            continue;
+        }
+        char name[PATH_MAX];
+        if (sscanf(line, "%*s %*s %4095s", name) == 1) {
+            char oldPath[PATH_MAX + 600];
+            snprintf(oldPath, sizeof(oldPath), "%s%s", directory, name);
+            if (unlink(oldPath) == -1 && errno != ENOENT) perror("Error removing old log segment");
+        }
+    }
+    fclose(index);
+    if (fclose(temp) != 0 || rename(tempPath, indexPath) == -1) {
+        perror("Error replacing log segment index");
+    }
+}
+
+// 로그 조각을 gzip으로 압축하고 원본 삭제 (압축하면서 첫/마지막 이벤트 시각도 찾음)
+void compress_log_segment(const char* path, char* buffer) {
+    char tempPath[PATH_MAX];
+    char compressedPath[PATH_MAX];
+    snprintf(tempPath, sizeof(tempPath), "%s.gz.tmp", path);
+    snprintf(compressedPath, sizeof(compressedPath), "%s.gz", path);
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror("Error opening log segment");
+        return;
+    }
+    gzFile compressed = gzopen(tempPath, "wb6e");
+    if (!compressed) {
+        fprintf(stderr, "Error creating %s\n", tempPath);
+        close(fd);
+        return;
+    }
+
+    // 시각 문자열은 사전 순서가 시간 순서와 같으므로 문자열로 비교
+    char firstStamp[LOG_TIMESTAMP_LENGTH + 1] = "";
+    char lastStamp[LOG_TIMESTAMP_LENGTH + 1] = "";
+    char lineStart[LOG_TIMESTAMP_LENGTH + 8 + 1]; // 버퍼 경계에 걸친 줄 앞부분
+    size_t lineStartLength = 0;
+    bool atLineStart = true;
+    bool failed = false;
+
+    ssize_t readLength;
+    while ((readLength = read(fd, buffer, LOG_COMPRESS_BUFFER_SIZE)) > 0) {
+        if (gzwrite(compressed, buffer, (unsigned)readLength) != (int)readLength) {
+            failed = true;
+            break;
+        }
+        for (ssize_t i = 0; i < readLength; ++i) {
+            if (atLineStart && lineStartLength < sizeof(lineStart) - 1) {
+                lineStart[lineStartLength++] = buffer[i];
+                if (lineStartLength == sizeof(lineStart) - 1) {
+                    lineStart[lineStartLength] = '\0';
+                    if (strncmp(lineStart, "Event: [", 8) == 0) {
+                        const char* stamp = lineStart + 8;
+                        if (!firstStamp[0] || strncmp(stamp, firstStamp, LOG_TIMESTAMP_LENGTH) < 0) memcpy(firstStamp, stamp, LOG_TIMESTAMP_LENGTH);
+                        if (strncmp(stamp, lastStamp, LOG_TIMESTAMP_LENGTH) > 0) memcpy(lastStamp, stamp, LOG_TIMESTAMP_LENGTH);
+                    }
+                    atLineStart = false;
+                }
+            }
+            if (buffer[i] == '\n') {
+                atLineStart = true;
+                lineStartLength = 0;
+            }
+        }
+    }
+    if (readLength == -1) failed = true;
+    close(fd);
+    if (gzclose(compressed) != Z_OK) failed = true;
+
+    // 압축 파일을 디스크에 반영한 뒤에만 원본 삭제
+    int compressedFd = failed ? -1 : open(tempPath, O_RDONLY | O_CLOEXEC);
+    if (compressedFd == -1 || fsync(compressedFd) == -1 || rename(tempPath, compressedPath) == -1) {
+        fprintf(stderr, "Error compressing log segment %s\n", path);
+        if (compressedFd != -1) close(compressedFd);
+        unlink(tempPath);
+        return;
+    }
+    close(compressedFd);
+    unlink(path);
+
+    const char* name = strrchr(compressedPath, '/');
+    update_segment_index(name ? name + 1 : compressedPath, firstStamp[0] ? parse_log_timestamp(firstStamp) : 0,
+                         lastStamp[0] ? parse_log_timestamp(lastStamp) : 0);
+}
+
+// 로그 조각 이름인지 확인: "<로그 파일 이름>.YYYYMMDD-HHMMSS" 또는 뒤에 ".N"
+bool is_log_segment_name(const char* name, const char* base) {
+    size_t baseLength = strlen(base);
+    if (strncmp(name, base, baseLength) != 0 || name[baseLength] != '.') return false;
+
+    const char* stamp = name + baseLength + 1;
+    for (int i = 0; i < 15; ++i) {
+        if (i == 8 ? stamp[i] != '-' : (stamp[i] < '0' || stamp[i] > '9')) return false;
+    }
+    if (stamp[15] == '\0') return true;
+    if (stamp[15] != '.' || !stamp[16]) return false;
+    for (const char* c = stamp + 16; *c; ++c) {
+        if (*c < '0' || *c > '9') return false;
+    }
+    return true;
+}
+
+// 이전 실행에서 교체만 되고 압축되지 않은 조각을 다시 큐에 넣음
+void queue_leftover_segments() {
+    char directory[600];
+    snprintf(directory, sizeof(directory), "%s", logFilePath);
+    char* slash = strrchr(directory, '/');
+    const char* base = slash ? slash + 1 : logFilePath;
+    if (slash) *slash = '\0';
+    else snprintf(directory, sizeof(directory), ".");
+
+    DIR* dir = opendir(directory[0] ? directory : "/");
+    if (!dir) return;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        char path[PATH_MAX];
+        size_t nameLength = strlen(entry->d_name);
+        if (nameLength > 7 && strcmp(entry->d_name + nameLength - 7, ".gz.tmp") == 0) {
+            char original[NAME_MAX + 1];
+            snprintf(original, sizeof(original), "%.*s", (int)(nameLength - 7), entry->d_name);
+            if (is_log_segment_name(original, base)) { // 압축 도중 종료된 임시 파일
+                snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+                unlink(path);
+            }
+        }
+        else if (is_log_segment_name(entry->d_name, base)) {
+            snprintf(path, sizeof(path), "%s/%s", directory, entry->d_name);
+            queue_log_compression(path);
+        }
+    }
+    closedir(dir);
+}
+
+// 압축 스레드: 가장 낮은 CPU/IO 우선순위로 교체된 로그 조각을 압축
+void* log_compressor_thread(void* arg) {
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+    setpriority(PRIO_PROCESS, (id_t)tid, 19);
+    syscall(SYS_ioprio_set, 1, tid, 3 << 13); // IOPRIO_WHO_PROCESS, IOPRIO_CLASS_IDLE
+
+    char* buffer = malloc(LOG_COMPRESS_BUFFER_SIZE);
+    if (!buffer) {
+        fprintf(stderr, "Error allocating log compression buffer\n");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&compressLock);
+    for (;;) {
+        while (!compressQueueHead && compressorRunning) {
+            pthread_cond_wait(&compressReady, &compressLock);
+        }
+        LogSegment* segment = compressQueueHead;
+        if (!segment) break; // 종료 요청 (남은 조각은 다음 실행에서 압축)
+        compressQueueHead = segment->next;
+        if (!compressQueueHead) compressQueueTail = NULL;
+        pthread_mutex_unlock(&compressLock);
+
+        compress_log_segment(segment->path, buffer);
+        free(segment);
+
+        pthread_mutex_lock(&compressLock);
+        if (!compressorRunning) break;
+    }
+    pthread_mutex_unlock(&compressLock);
+
+    free(buffer);
+    return NULL;
+}
+
+// 로그 기록 스레드: 이벤트를 모아 한 번의 writev로 기록하고, 설정된 주기로만 fdatasync
+void* log_writer_thread(void* arg) {
+    char* buffers = malloc((size_t)LOG_WRITE_CHUNKS * LOG_WRITE_CHUNK_SIZE);
+    if (!buffers) {
+        fprintf(stderr, "Error allocating log write buffers\n");
+        return NULL;
+    }
+
+    uint64_t droppedReported = 0;
+    bool unsynced = false;                // 아직 fdatasync하지 않은 기록이 있는지 여부
+    int64_t lastSyncMs = monotonic_ms();
+
+    for (;;) {
+        bool running = logWriterRunning;  // 종료 요청 전에 들어온 이벤트까지 모두 기록
+        if (drain_log_ring(buffers, &droppedReported) > 0) unsynced = true;
+
+        int64_t nowMs = monotonic_ms();
+        if (unsynced && logSyncIntervalMs >= 0 && (!running || nowMs - lastSyncMs >= logSyncIntervalMs)) {
+            if (fdatasync(LogFd) == -1) perror("Error syncing log file");
+            if (JournalFd != -1) sync_journal();
+            unsynced = false;
+            lastSyncMs = nowMs;
+        }
+        if (!running) break;
+        rotate_log_if_needed();
+
+        // 잠들기 전에 표시하고 다시 확인해야 그 사이 들어온 이벤트의 깨우기를 놓치지 않음
+        __atomic_store_n(&logWriterSleeping, 1, __ATOMIC_SEQ_CST);
+        if (spsc_ring_empty(&logRing) && logWriterRunning) {
+            int timeoutMs = LOG_IDLE_TIMEOUT_MS;
+            if (unsynced && logSyncIntervalMs > 0) {
+                int64_t untilSync = lastSyncMs + logSyncIntervalMs - nowMs;
+                timeoutMs = untilSync < 0 ? 0 : (int)(untilSync < timeoutMs ? untilSync : timeoutMs);
+            }
+            struct pollfd wakeup = { .fd = LogWakeupFd, .events = POLLIN };
+            if (poll(&wakeup, 1, timeoutMs) > 0) {
+                uint64_t count;
+                while (read(LogWakeupFd, &count, sizeof(count)) > 0) {
+                    // 깨우기 카운터 비우기
+                }
+            }
+        }
+        __atomic_store_n(&logWriterSleeping, 0, __ATOMIC_SEQ_CST);
+    }
+
+    free(buffers);
+    return NULL;
+}
+
+// 로그 기록 스레드 시작 (실패 시 -1)
+int start_log_writer() {
+    struct stat logStat;
+    if (fstat(LogFd, &logStat) == 0) logFileSize = logStat.st_size;
+    logSegmentStart = time(NULL);
+
+    if (logRotateSizeMb > 0 || logRotateHours > 0) {
+        compressorRunning = true;
+        queue_leftover_segments();
+        if (pthread_create(&compressorThread, NULL, log_compressor_thread, NULL) != 0) {
+            fprintf(stderr, "Error starting log compressor thread\n");
+            compressorRunning = false;
+        }
+    }
+
+    if (journalFilePath[0] && open_journal(journalFilePath) == -1) {
+        return -1;
+    }
+    if (spsc_ring_init(&logRing, LOG_RING_CAPACITY, sizeof(EventRecord)) == -1) {
+        return -1;
+    }
+    LogWakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (LogWakeupFd == -1) {
+        perror("Error creating log writer eventfd");
+        return -1;
+    }
+    if (pthread_create(&logWriterThread, NULL, log_writer_thread, NULL) != 0) {
+        fprintf(stderr, "Error starting log writer thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+// 잠든 로그 기록 스레드 깨우기
+void wakeup_log_writer() {
+    uint64_t one = 1;
+    if (write(LogWakeupFd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        perror("Error writing log writer eventfd");
+    }
+}
+
+// 남은 이벤트를 모두 기록하고 로그 기록 스레드 종료
+void stop_log_writer() {
+    logWriterRunning = 0;
+    wakeup_log_writer();
+    pthread_join(logWriterThread, NULL);
+
+    if (compressorRunning) { // 진행 중인 조각 하나만 마치고 종료
+        pthread_mutex_lock(&compressLock);
+        compressorRunning = false;
+        pthread_cond_signal(&compressReady);
+        pthread_mutex_unlock(&compressLock);
+        pthread_join(compressorThread, NULL);
+        while (compressQueueHead) {
+            LogSegment* next = compressQueueHead->next;
+            free(compressQueueHead);
+            compressQueueHead = next;
+        }
+    }
+    close(LogWakeupFd);
+    close(LogFd);
+    if (JournalFd != -1) {
+        close(JournalFd);
+        close(JournalStringFd);
+        close(JournalIndexFd);
+    }
+    free(journalStrings);
+    free(journalStringSlots);
+    free(logRing.slots);
+}
+
+int64_t realtime_ns();
+
+// 공유 메모리 이벤트 링 만들기 (실패 시 -1)
+int init_event_ring(const char* name) {
+    uint32_t slotCount = 1;
+    while (slotCount < (uint32_t)eventRingSlots && slotCount < (1u << 24)) slotCount <<= 1;
+
+    shm_unlink(name); // 이전 실행이 남긴 링 (이미 연 읽는 쪽은 옛 링을 계속 봄)
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "Error creating event ring %s: %s\n", name, strerror(errno));
+        return -1;
+    }
+
+    eventRingMapSize = sizeof(EventRingHeader) + (size_t)slotCount * sizeof(EventRingSlot);
+    void* map = MAP_FAILED;
+    if (ftruncate(fd, (off_t)eventRingMapSize) == 0) {
+        map = mmap(NULL, eventRingMapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error mapping event ring %s: %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return -1;
+    }
+
+    eventRing = map;
+    eventRingSlotArray = (EventRingSlot*)((char*)map + sizeof(EventRingHeader));
+    eventRing->version = EVENT_RING_VERSION;
+    eventRing->slotSize = sizeof(EventRingSlot);
+    eventRing->slotCount = slotCount;
+    eventRing->firstSequence = eventSequence + 1;
+    eventRing->writeSequence = eventSequence;
+    eventRing->writerPid = (uint32_t)getpid();
+    __atomic_store_n(&eventRing->magic, EVENT_RING_MAGIC, __ATOMIC_RELEASE); // 헤더를 다 쓴 뒤에 표시
+    printf("Event ring: %s (%u slots)\n", name, slotCount);
+    return 0;
+}
+
+// 이벤트를 다음 슬롯에 씀 (읽는 쪽을 기다리지 않음)
+void publish_event_ring(const EventRecord* record) {
+    EventRingSlot* slot = &eventRingSlotArray[record->sequence & (eventRing->slotCount - 1)];
+
+    // 읽는 쪽이 쓰는 중인 슬롯을 믿지 않도록 먼저 번호를 지움
+    __atomic_store_n(&slot->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    const char* oldPath = record->oldPathOffset > 0 ? record->path + record->oldPathOffset : NULL;
+    size_t pathLength = strlen(record->path);
+    size_t oldPathLength = oldPath ? strlen(oldPath) : 0;
+    slot->flags = 0;
+    if (pathLength + 1 + (oldPath ? oldPathLength + 1 : 0) > sizeof(slot->path)) {
+        slot->flags |= EVENT_RING_TRUNCATED; // 이전 경로를 버리고 경로를 자름
+        oldPath = NULL;
+        if (pathLength >= sizeof(slot->path)) pathLength = sizeof(slot->path) - 1;
+    }
+    slot->timeNs = record->eventTimeNs;
+    slot->mask = record->mask;
+    slot->count = record->count;
+    slot->pathLength = (uint16_t)pathLength;
+    memcpy(slot->path, record->path, pathLength);
+    slot->path[pathLength] = '\0';
+    slot->oldPathOffset = 0;
+    if (oldPath) {
+        slot->oldPathOffset = (uint16_t)(pathLength + 1);
+        memcpy(slot->path + pathLength + 1, oldPath, oldPathLength + 1);
+    }
+
+    __atomic_store_n(&slot->sequence, record->sequence, __ATOMIC_RELEASE);
+    __atomic_store_n(&eventRing->writeSequence, record->sequence, __ATOMIC_RELEASE);
+}
+
+// 이벤트 링 닫기 (이름은 남겨 두어 읽는 쪽이 마지막 이벤트까지 읽을 수 있게 함)
+void close_event_ring() {
+    if (!eventRing) return;
+    __atomic_store_n(&eventRing->closed, 1, __ATOMIC_RELEASE);
+    munmap(eventRing, eventRingMapSize);
+    eventRing = NULL;
+}
+
+// 변경 색인 초기화 (실패 시 -1)
+int init_change_index() {
+    uint32_t bucketCount = 16;
+    while (bucketCount < (uint32_t)changeIndexMaxPaths * 2) bucketCount <<= 1;
+
+    changeIndex.entries = malloc((size_t)changeIndexMaxPaths * sizeof(ChangeEntry));
+    changeIndex.buckets = malloc(bucketCount * sizeof(int32_t));
+    if (!changeIndex.entries || !changeIndex.buckets) return -1;
+    memset(changeIndex.buckets, 0xff, bucketCount * sizeof(int32_t));
+    changeIndex.bucketMask = bucketCount - 1;
+    changeIndex.count = 0;
+    changeIndex.oldest = changeIndex.newest = -1;
+    changeIndex.floorSequence = eventSequence; // 시작 전의 변경은 알 수 없음
+    return 0;
+}
+
+// 항목을 변경 순서 목록에서 떼어냄
+void change_index_unlink(int32_t index) {
+    ChangeEntry* entry = &changeIndex.entries[index];
+    if (entry->prev != -1) changeIndex.entries[entry->prev].next = entry->next;
+    else changeIndex.oldest = entry->next;
+    if (entry->next != -1) changeIndex.entries[entry->next].prev = entry->prev;
+    else changeIndex.newest = entry->prev;
+}
+
+// 가장 오래된 항목을 버리고 그 자리를 돌려줌
+int32_t change_index_evict() {
+    int32_t index = changeIndex.oldest;
+    ChangeEntry* entry = &changeIndex.entries[index];
+    change_index_unlink(index);
+
+    int32_t* link = &changeIndex.buckets[entry->hash & changeIndex.bucketMask];
+    while (*link != index) link = &changeIndex.entries[*link].hashNext;
+    *link = entry->hashNext;
+
+    changeIndex.floorSequence = entry->sequence; // 이 번호까지의 변경은 더 이상 모두 알 수 없음
+    free(entry->path);
+    return index;
+}
+
+// 경로의 마지막 변경 기록 (같은 경로는 항목 하나로 합침)
+void change_index_record(const char* path, uint64_t sequence, int64_t timeNs, uint32_t mask) {
+    uint64_t hash = journal_path_hash(path);
+    int32_t* bucket = &changeIndex.buckets[hash & changeIndex.bucketMask];
+    int32_t index = *bucket;
+    while (index != -1 && (changeIndex.entries[index].hash != hash || strcmp(changeIndex.entries[index].path, path) != 0)) {
+        index = changeIndex.entries[index].hashNext;
+    }
+
+    if (index != -1) {
+        change_index_unlink(index);
+    }
+    else {
+        char* copy = strdup(path);
+        if (!copy) return;
+        index = changeIndex.count < changeIndexMaxPaths ? changeIndex.count++ : change_index_evict();
+        bucket = &changeIndex.buckets[hash & changeIndex.bucketMask]; // 버킷 연결이 바뀌었을 수 있음
+        changeIndex.entries[index].path = copy;
+        changeIndex.entries[index].hash = hash;
+        changeIndex.entries[index].hashNext = *bucket;
+        *bucket = index;
+    }
+
+    // 가장 최근 변경으로 이동
+    ChangeEntry* entry = &changeIndex.entries[index];
+    entry->sequence = sequence;
+    entry->timeNs = timeNs;
+    entry->mask = mask;
+    entry->prev = changeIndex.newest;
+    entry->next = -1;
+    if (changeIndex.newest != -1) changeIndex.entries[changeIndex.newest].next = index;
+    else changeIndex.oldest = index;
+    changeIndex.newest = index;
+}
+
+// 이벤트를 변경 색인에 반영 (이름 변경은 이전 경로도 기록)
+void change_index_event(const EventRecord* record) {
+    if (record->mask & IN_Q_OVERFLOW) return; // 알림은 경로 변경이 아님
+    if (record->oldPathOffset > 0) {
+        change_index_record(record->path + record->oldPathOffset, record->sequence, record->eventTimeNs,
+                            IN_MOVED_FROM | (record->mask & IN_ISDIR));
+        change_index_record(record->path, record->sequence, record->eventTimeNs, IN_MOVED_TO | (record->mask & IN_ISDIR));
+    }
+    else {
+        change_index_record(record->path, record->sequence, record->eventTimeNs, record->mask);
+    }
+}
+
+void free_change_index() {
+    for (int32_t i = 0; i < changeIndex.count; ++i) {
+        free(changeIndex.entries[i].path);
+    }
+    free(changeIndex.entries);
+    free(changeIndex.buckets);
+}
+
+// 경로가 root 아래에 있는지 확인 (root는 끝의 '/'를 뺀 형태)
+bool path_in_root(const char* path, const char* root, size_t rootLength) {
+    return rootLength == 1 ||
+           (strncmp(path, root, rootLength) == 0 && (path[rootLength] == '/' || path[rootLength] == '\0'));
+}
+
+// 구독자 연결 종료
+void close_subscriber(int index) {
+    Subscriber* subscriber = subscribers[index];
+    epoll_ctl(EpollFd, EPOLL_CTL_DEL, subscriber->fd, NULL);
+    close(subscriber->fd);
+    free(subscriber->buffer);
+    free(subscriber);
+    subscribers[index] = subscribers[--subscriberCount];
+}
+
+// fd로 구독자 찾기 (없으면 -1)
+int find_subscriber(int fd) {
+    for (int i = 0; i < subscriberCount; ++i) {
+        if (subscribers[i]->fd == fd) return i;
+    }
+    return -1;
+}
+
+// 구독자 버퍼에 프레임 추가 (공간이 없으면 false)
+bool append_subscriber_frame(Subscriber* subscriber, uint16_t type, uint64_t sequence, int64_t timeNs, uint32_t mask,
+                             uint32_t count, const char* path, const char* oldPath) {
+    size_t pathLength = strlen(path) + 1;
+    size_t oldPathLength = oldPath ? strlen(oldPath) + 1 : 0;
+    size_t frameLength = (sizeof(EventFrame) + pathLength + oldPathLength + 7) & ~(size_t)7;
+    size_t capacity = (size_t)subscriberBufferKb * 1024;
+
+    if (subscriber->tail + frameLength > capacity && subscriber->head > 0) { // 이미 보낸 앞부분을 정리
+        memmove(subscriber->buffer, subscriber->buffer + subscriber->head, subscriber->tail - subscriber->head);
+        subscriber->tail -= subscriber->head;
+        subscriber->head = 0;
+    }
+    if (subscriber->tail + frameLength > capacity) return false;
+
+    EventFrame* frame = (EventFrame*)(subscriber->buffer + subscriber->tail);
+    memset(frame, 0, frameLength);
+    frame->length = (uint32_t)frameLength;
+    frame->type = type;
+    frame->oldPathOffset = oldPath ? (uint16_t)pathLength : 0;
+    frame->sequence = sequence;
+    frame->timeNs = timeNs;
+    frame->mask = mask;
+    frame->count = count;
+    memcpy(frame->path, path, pathLength);
+    if (oldPath) memcpy(frame->path + pathLength, oldPath, oldPathLength);
+    subscriber->tail += frameLength;
+    return true;
+}
+
+// 구독자 fd의 epoll 이벤트 갱신
+// 다 보내지 못했을 때만 EPOLLOUT으로 다시 깨어나고, 요청을 미룬 동안은 더 읽지 않고 보낼 수 있을 때 다시 처리
+void update_subscriber_events(Subscriber* subscriber) {
+    bool pending = subscriber->head < subscriber->tail || subscriber->dropped > 0;
+    uint32_t events = subscriber->requestDeferred ? EPOLLOUT : EPOLLIN | (pending ? EPOLLOUT : 0);
+    if (events != subscriber->epollEvents) {
+        struct epoll_event ev = { .events = events };
+        ev.data.fd = subscriber->fd;
+        epoll_ctl(EpollFd, EPOLL_CTL_MOD, subscriber->fd, &ev);
+        subscriber->epollEvents = events;
+    }
+}
+
+// 구독자 버퍼를 보낼 수 있는 만큼 보냄 (연결이 끊겼으면 -1)
+int flush_subscriber(Subscriber* subscriber) {
+    while (subscriber->head < subscriber->tail) {
+        ssize_t sent = send(subscriber->fd, subscriber->buffer + subscriber->head, subscriber->tail - subscriber->head,
+                            MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0) {
+            subscriber->head += (size_t)sent;
+            continue;
+        }
+        if (sent == -1 && errno == EINTR) continue;
+        if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        return -1;
+    }
+    if (subscriber->head == subscriber->tail) subscriber->head = subscriber->tail = 0;
+
+    // 버린 이벤트가 있으면 공간이 생긴 뒤 한 번에 알림
+    if (subscriber->dropped > 0 &&
+        append_subscriber_frame(subscriber, EVENT_FRAME_DROPPED, eventSequence, realtime_ns(), 0, (uint32_t)subscriber->dropped, "", NULL)) {
+        subscriber->dropped = 0;
+    }
+
+    update_subscriber_events(subscriber);
+    return 0;
+}
+
+// 이벤트 종류 목록("create,delete,modify,move")을 마스크로 변환 (알 수 없는 이름이면 0)
+uint32_t parse_subscription_kinds(char* kinds) {
+    if (kinds[0] == '\0' || strcmp(kinds, "all") == 0) return IN_ALL_EVENTS;
+
+    uint32_t mask = 0;
+    for (char* save = NULL, *kind = strtok_r(kinds, ",", &save); kind; kind = strtok_r(NULL, ",", &save)) {
+        if (strcmp(kind, "create") == 0) mask |= IN_CREATE;
+        else if (strcmp(kind, "delete") == 0) mask |= IN_DELETE;
+        else if (strcmp(kind, "modify") == 0) mask |= IN_MODIFY;
+        else if (strcmp(kind, "move") == 0) mask |= IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF;
+        else return 0;
+    }
+    return mask;
+}
+
+// 루트 경로 끝의 '/'를 지움 ("/a/b/"와 "/a/b"를 같게 취급, 길이 반환)
+size_t trim_root(char* root) {
+    size_t length = strlen(root);
+    while (length > 1 && root[length - 1] == '/') {
+        root[--length] = '\0';
+    }
+    return length;
+}
+
+// 커서 토큰 만들기 ("실행 구분값:순서 번호")
+void format_cursor_token(uint64_t sequence, char* token, size_t tokenSize) {
+    snprintf(token, tokenSize, "%lld:%llu", (long long)runEpochNs, (unsigned long long)sequence);
+}
+
+// 커서 이후 바뀐 경로를 오래된 순서로 보냄
+// 버퍼가 모자라면 보낸 곳까지의 커서를 주고 나머지는 다음 요청으로 넘김
+// (요청은 SUBSCRIBER_REPLY_RESERVE만큼 비어 있을 때만 처리하므로 RESET/커서 프레임은 항상 들어감)
+void send_changes_since(Subscriber* subscriber, const char* token, char* root) {
+    long long epoch = 0;
+    unsigned long long cursor = 0;
+    char end = '\0';
+    char cursorToken[64];
+
+    // 다른 실행의 커서이거나 색인에서 이미 빠진 구간이면 처음부터 다시 맞춰야 함
+    if (sscanf(token, "%lld:%llu%c", &epoch, &cursor, &end) != 2 || epoch != runEpochNs ||
+        cursor < changeIndex.floorSequence || cursor > eventSequence) {
+        format_cursor_token(eventSequence, cursorToken, sizeof(cursorToken));
+        append_subscriber_frame(subscriber, EVENT_FRAME_RESET, eventSequence, realtime_ns(), 0, 0, cursorToken, NULL);
+        return;
+    }
+
+    size_t rootLength = trim_root(root);
+    size_t capacity = (size_t)subscriberBufferKb * 1024;
+    size_t cursorFrameLength = (sizeof(EventFrame) + sizeof(cursorToken) + 7) & ~(size_t)7;
+
+    // 최근 변경부터 거슬러 올라가 커서 이후의 첫 항목을 찾음 (바뀐 경로 수에만 비례)
+    int32_t first = -1;
+    for (int32_t index = changeIndex.newest; index != -1 && changeIndex.entries[index].sequence > cursor;
+         index = changeIndex.entries[index].prev) {
+        first = index;
+    }
+
+    uint64_t sentUntil = eventSequence;
+    uint32_t sentCount = 0;
+    for (int32_t index = first; index != -1; index = changeIndex.entries[index].next) {
+        const ChangeEntry* entry = &changeIndex.entries[index];
+        if (!path_in_root(entry->path, root, rootLength)) continue;
+
+        // 마지막 커서 프레임을 위한 공간을 남겨 둠
+        size_t frameLength = (sizeof(EventFrame) + strlen(entry->path) + 1 + 7) & ~(size_t)7;
+        if (subscriber->tail - subscriber->head + frameLength + cursorFrameLength > capacity) {
+            sentUntil = entry->sequence - 1; // 같은 순서 번호의 항목(이름 변경 짝)은 다음 요청에서 다시 나옴
+            break;
+        }
+        append_subscriber_frame(subscriber, EVENT_FRAME_CHANGE, entry->sequence, entry->timeNs, entry->mask, 0, entry->path, NULL);
+        sentCount++;
+    }
+
+    format_cursor_token(sentUntil, cursorToken, sizeof(cursorToken));
+    append_subscriber_frame(subscriber, EVENT_FRAME_CURSOR, sentUntil, realtime_ns(),
+                            sentUntil != eventSequence ? EVENT_CURSOR_MORE : 0, sentCount, cursorToken, NULL);
+}
+
+// 요청 줄 처리 (잘못된 요청이면 오류 프레임을 보내고 -1)
+int handle_subscription_request(Subscriber* subscriber, char* line) {
+    // 탭마다 필드를 나눔 (연속된 탭 사이의 빈 필드는 생략한 것으로 취급)
+    char* fields[4] = { NULL, NULL, "", "" };
+    int fieldCount = 0;
+    for (char* rest = line; rest && fieldCount < 4;) {
+        fields[fieldCount++] = strsep(&rest, "\t");
+    }
+
+    const char* error = NULL;
+    if (fieldCount >= 2 && strcmp(fields[0], "CHANGES") == 0) {
+        if (fieldCount > 3) error = "expected CHANGES<TAB>cursor[<TAB>root]";
+        else if (fieldCount == 2 || fields[2][0] == '\0') fields[2] = "/";
+    }
+    else if (fieldCount < 2 || strcmp(fields[0], "SUBSCRIBE") != 0) error = "expected SUBSCRIBE<TAB>root[<TAB>kinds[<TAB>suffix]]";
+    else if (subscriber->subscribed) error = "already subscribed";
+    else if (strlen(fields[1]) >= sizeof(subscriber->root) || strlen(fields[3]) >= sizeof(subscriber->suffix)) error = "root or suffix too long";
+    else if ((subscriber->mask = parse_subscription_kinds(fields[2])) == 0) error = "unknown event kind";
+    if (error) {
+        append_subscriber_frame(subscriber, EVENT_FRAME_ERROR, 0, realtime_ns(), 0, 0, error, NULL);
+        flush_subscriber(subscriber);
+        return -1;
+    }
+
+    if (strcmp(fields[0], "CHANGES") == 0) {
+        send_changes_since(subscriber, fields[1], fields[2]);
+        return flush_subscriber(subscriber);
+    }
+
+    strcpy(subscriber->root, fields[1]);
+    subscriber->rootLength = trim_root(subscriber->root);
+    strcpy(subscriber->suffix, fields[3]);
+    subscriber->subscribed = true;
+
+    // 같은 루프 반복 안에서 처리하므로 CHANGES 직후에 구독하면 빠지는 이벤트가 없음
+    append_subscriber_frame(subscriber, EVENT_FRAME_SUBSCRIBED, eventSequence, runEpochNs, 0, EVENT_STREAM_VERSION, subscriber->root, NULL);
+    return flush_subscriber(subscriber);
+}
+
+// 받은 요청 줄을 차례로 처리하고 남은 조각은 앞으로 옮김 (연결을 닫아야 하면 -1)
+// 답할 공간이 없거나 버린 이벤트 알림이 아직 나가지 않았으면 그 줄부터 미룸 (답이 알림을 앞지르지 않도록)
+int handle_subscription_requests(Subscriber* subscriber) {
+    size_t capacity = (size_t)subscriberBufferKb * 1024;
+    char* line = subscriber->request;
+    subscriber->requestDeferred = false;
+    for (char* newline; (newline = strchr(line, '\n')) != NULL; line = newline + 1) {
+        if (subscriber->dropped > 0 || capacity - (subscriber->tail - subscriber->head) < SUBSCRIBER_REPLY_RESERVE) {
+            subscriber->requestDeferred = true;
+            break;
+        }
+        *newline = '\0';
+        if (newline > line && newline[-1] == '\r') newline[-1] = '\0';
+        if (handle_subscription_request(subscriber, line) == -1) return -1;
+    }
+    subscriber->requestLength -= (size_t)(line - subscriber->request);
+    memmove(subscriber->request, line, subscriber->requestLength + 1);
+    update_subscriber_events(subscriber);
+    return 0;
+}
+
+// 구독자가 보낸 데이터 읽기 (연결을 닫아야 하면 -1)
+int read_subscriber(Subscriber* subscriber) {
+    while (!subscriber->requestDeferred) {
+        char* space = subscriber->request + subscriber->requestLength;
+        size_t spaceLength = sizeof(subscriber->request) - subscriber->requestLength - 1;
+        ssize_t readLength = recv(subscriber->fd, space, spaceLength, MSG_DONTWAIT);
+        if (readLength == 0) return -1; // 연결 종료
+        if (readLength == -1) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+
+        subscriber->requestLength += (size_t)readLength;
+        subscriber->request[subscriber->requestLength] = '\0';
+
+        if (handle_subscription_requests(subscriber) == -1) return -1;
+        if (!subscriber->requestDeferred && subscriber->requestLength == sizeof(subscriber->request) - 1) return -1; // 줄이 너무 김
+    }
+    return 0;
+}
+
+// 새 연결 받기
+void accept_subscribers() {
+    for (;;) {
+        int fd = accept4(SubscribeServerFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("Error accepting subscriber");
+            return;
+        }
+
+        Subscriber* subscriber = subscriberCount < SUBSCRIBER_MAX ? calloc(1, sizeof(Subscriber)) : NULL;
+        char* buffer = subscriber ? malloc((size_t)subscriberBufferKb * 1024) : NULL;
+        struct epoll_event ev = { .events = EPOLLIN };
+        ev.data.fd = fd;
+        if (!buffer || epoll_ctl(EpollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            fprintf(stderr, "Rejecting subscriber: %s\n", subscriber ? "out of resources" : "too many subscribers");
+            free(buffer);
+            free(subscriber);
+            close(fd);
+            continue;
+        }
+        subscriber->fd = fd;
+        subscriber->buffer = buffer;
+        subscriber->epollEvents = EPOLLIN;
+        subscribers[subscriberCount++] = subscriber;
+    }
+}
+
+// 구독 소켓 epoll 이벤트 처리 (구독 소켓 fd가 아니면 false)
+bool handle_subscriber_event(const struct epoll_event* event) {
+    if (event->data.fd == SubscribeServerFd) {
+        accept_subscribers();
+        return true;
+    }
+
+    int index = find_subscriber(event->data.fd);
+    if (index < 0) return false;
+
+    Subscriber* subscriber = subscribers[index];
+    if ((event->events & (EPOLLERR | EPOLLHUP)) ||
+        ((event->events & EPOLLIN) && read_subscriber(subscriber) == -1) ||
+        ((event->events & EPOLLOUT) && flush_subscriber(subscriber) == -1) ||
+        ((event->events & EPOLLOUT) && subscriber->requestDeferred && handle_subscription_requests(subscriber) == -1)) {
+        close_subscriber(index);
+    }
+    return true;
+}
+
+// 이벤트를 조건이 맞는 구독자 버퍼에 넣음 (실제 전송은 루프 끝에서 한 번에)
+void publish_event(const EventRecord* record) {
+    const char* oldPath = record->oldPathOffset > 0 ? record->path + record->oldPathOffset : NULL;
+    bool notice = (record->mask & IN_Q_OVERFLOW) != 0; // 오버플로 알림은 필터와 상관없이 모두에게
+
+    for (int i = 0; i < subscriberCount; ++i) {
+        Subscriber* subscriber = subscribers[i];
+        if (!subscriber->subscribed) continue;
+
+        if (!notice) {
+            if (!(record->mask & subscriber->mask)) continue;
+
+            bool inRoot = false;
+            for (const char* path = record->path; path && !inRoot; path = path == oldPath ? NULL : oldPath) {
+                inRoot = path_in_root(path, subscriber->root, subscriber->rootLength);
+            }
+            if (!inRoot) continue;
+
+            if (subscriber->suffix[0]) {
+                size_t pathLength = strlen(record->path);
+                size_t suffixLength = strlen(subscriber->suffix);
+                if (pathLength < suffixLength || strcmp(record->path + pathLength - suffixLength, subscriber->suffix) != 0) continue;
+            }
+        }
+
+        if (subscriber->dropped == 0 &&
+            append_subscriber_frame(subscriber, EVENT_FRAME_EVENT, record->sequence, record->eventTimeNs, record->mask,
+                                    record->count, record->path, oldPath)) {
+            continue;
+        }
+        if (subscriberDisconnectOnFull) {
+            fprintf(stderr, "Disconnecting slow subscriber (buffer full)\n");
+            close_subscriber(i--);
+        }
+        else {
+            subscriber->dropped++; // 순서를 지키기 위해 알림을 보낼 때까지 이후 이벤트도 버림
+        }
+    }
+}
+
+// 쌓인 프레임을 구독자마다 한 번의 send로 보냄
+void flush_subscribers() {
+    for (int i = 0; i < subscriberCount; ++i) {
+        Subscriber* subscriber = subscribers[i];
+        if ((subscriber->head < subscriber->tail || subscriber->dropped > 0) && !(subscriber->epollEvents & EPOLLOUT) &&
+            flush_subscriber(subscriber) == -1) {
+            close_subscriber(i--);
+        }
+    }
+}
+
+// 구독 소켓 열기 (실패 시 -1)
+int init_subscription_server(const char* path) {
+    SubscribeServerFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (SubscribeServerFd == -1) {
+        perror("Error creating subscription socket");
+        return -1;
+    }
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path, sizeof(address.sun_path) - 1);
+    unlink(path); // 이전 실행이 남긴 소켓 파일
+
+    if (bind(SubscribeServerFd, (struct sockaddr*)&address, sizeof(address)) == -1 ||
+        listen(SubscribeServerFd, SUBSCRIBER_MAX) == -1) {
+        fprintf(stderr, "Error listening on %s: %s\n", path, strerror(errno));
+        close(SubscribeServerFd);
+        SubscribeServerFd = -1;
+        return -1;
+    }
+
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.fd = SubscribeServerFd;
+    if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, SubscribeServerFd, &ev) == -1) {
+        perror("Error adding subscription socket to epoll");
+        return -1;
+    }
+    printf("Subscription socket listening at: %s\n", path);
+    return 0;
+}
+
+// 구독 소켓과 모든 연결 닫기
+void close_subscription_server() {
+    while (subscriberCount > 0) {
+        close_subscriber(subscriberCount - 1);
+    }
+    if (SubscribeServerFd != -1) {
+        close(SubscribeServerFd);
+        unlink(subscribeSocketPath);
+    }
+}
+
+// 로그 이벤트 함수
+void log_event(EventRecord* event) {
+    event->sequence = ++eventSequence;
+    change_index_event(event);
+
+    // 레코드를 링에 복사하고, 예약된 프레임이 없을 때만 GTK 메인 스레드에 타이머를 걺
+    EventRecord* slot;
+    if (!headless) {
+        slot = spsc_ring_reserve(&uiRing);
+        if (slot) {
+            memcpy(slot, event, sizeof(*slot));
+            spsc_ring_commit(&uiRing);
+        }
+        request_ui_frame();
+    }
+
+    // 로그 파일 기록은 기록 스레드에 넘기고, 잠들어 있을 때만 깨움 (디스크 대기 없음)
+    slot = spsc_ring_reserve(&logRing);
+    if (slot) {
+        memcpy(slot, event, sizeof(*slot));
+        spsc_ring_commit(&logRing);
+    }
+    if (__atomic_exchange_n(&logWriterSleeping, 0, __ATOMIC_SEQ_CST)) {
+        wakeup_log_writer();
+    }
+
+    if (eventRing) publish_event_ring(event);
+    publish_event(event);
+}
+
+// 설정 파일에서 디렉토리 및 로그 파일 경로 읽기
+void read_config(const char* configPath, char monitoredDirs[][512], int* dirCount) {
+    config_t cfg; // libconfig 설정 객체
+    config_init(&cfg); // 설정 객체 초기화
+
+    if (!config_read_file(&cfg, configPath)) {  // 설정 파일 읽기
+        fprintf(stderr, "Error reading config file %s: %s\n", configPath, config_error_text(&cfg));
+        config_destroy(&cfg);  // 설정 객체 해제
+        exit(EXT_ERR_CONFIG_FILE); // 설정 파일 오류 시 종료
+    }
+
+    const char* logPath = NULL;
+    if (config_lookup_string(&cfg, "log_file", &logPath)) { // 설정 파일에서 'log_file' 항목 읽기
+        strncpy(logFilePath, logPath, sizeof(logFilePath));  // 로그 파일 경로 저장
+    }
+    else {
+        fprintf(stderr, "Missing 'log_file' in config file\n");
+        config_destroy(&cfg); // 설정 객체 해제
+        exit(EXT_ERR_CONFIG_FILE); // 로그 파일 경로가 없으면 종료
+    }
+
+    const char* backend = NULL;
+    if (config_lookup_string(&cfg, "monitor_backend", &backend)) { // 감시 백엔드 읽기 ("inotify" 또는 "fanotify")
+        if (strcmp(backend, "fanotify") == 0) {
+            useFanotify = true;
+        }
+        else if (strcmp(backend, "inotify") != 0) {
+            fprintf(stderr, "Unknown 'monitor_backend' %s in config file\n", backend);
+            config_destroy(&cfg);
+            exit(EXT_ERR_CONFIG_FILE);
+        }
+    }
+
+    const char* journalPath = NULL;
+    if (config_lookup_string(&cfg, "journal_file", &journalPath)) { // 바이너리 저널 경로 읽기 (선택)
+        strncpy(journalFilePath, journalPath, sizeof(journalFilePath) - 1);
+    }
+
+    int rotateSizeMb = 0;
+    if (config_lookup_int(&cfg, "log_rotate_size_mb", &rotateSizeMb)) { // 로그 교체 크기 읽기
+        logRotateSizeMb = rotateSizeMb;
+    }
+
+    int rotateHours = 0;
+    if (config_lookup_int(&cfg, "log_rotate_hours", &rotateHours)) { // 로그 교체 주기 읽기
+        logRotateHours = rotateHours;
+    }
+
+    int keepSegments = 0;
+    if (config_lookup_int(&cfg, "log_keep_segments", &keepSegments)) { // 보관할 로그 조각 수 읽기
+        logKeepSegments = keepSegments;
+    }
+
+    const char* ringName = NULL;
+    if (config_lookup_string(&cfg, "event_ring_name", &ringName)) { // 공유 메모리 이벤트 링 이름 읽기 (선택)
+        strncpy(eventRingName, ringName, sizeof(eventRingName) - 1);
+    }
+
+    int viewCapacity = 0;
+    if (config_lookup_int(&cfg, "log_view_capacity", &viewCapacity) && viewCapacity > 0) { // 로그 창 줄 수 읽기
+        logViewCapacity = viewCapacity;
+    }
+
+    int interval = 0;
+    if (config_lookup_int(&cfg, "sound_interval_ms", &interval)) { // 이벤트 사운드 최소 간격 읽기
+        soundIntervalMs = interval;
+    }
+
+    int maxPaths = 0;
+    if (config_lookup_int(&cfg, "change_index_max_paths", &maxPaths) && maxPaths > 0) { // 변경 색인 크기 읽기
+        changeIndexMaxPaths = maxPaths;
+    }
+
+    int ringSlots = 0;
+    if (config_lookup_int(&cfg, "event_ring_slots", &ringSlots) && ringSlots > 0) { // 이벤트 링 슬롯 수 읽기
+        eventRingSlots = ringSlots;
+    }
+
+    const char* socketPath = NULL;
+    if (config_lookup_string(&cfg, "subscribe_socket", &socketPath)) { // 구독 소켓 경로 읽기 (선택)
+        strncpy(subscribeSocketPath, socketPath, sizeof(subscribeSocketPath) - 1);
+    }
+
+    int bufferKb = 0;
+    if (config_lookup_int(&cfg, "subscriber_buffer_kb", &bufferKb) && bufferKb > 0) { // 구독자 전송 버퍼 크기 읽기
+        subscriberBufferKb = bufferKb < SUBSCRIBER_BUFFER_MIN_KB ? SUBSCRIBER_BUFFER_MIN_KB : bufferKb;
+    }
+
+    const char* overflowPolicy = NULL;
+    if (config_lookup_string(&cfg, "subscriber_overflow", &overflowPolicy)) { // 느린 구독자 처리 방식 읽기
+        if (strcmp(overflowPolicy, "disconnect") == 0) subscriberDisconnectOnFull = true;
+        else if (strcmp(overflowPolicy, "drop") != 0) {
+            fprintf(stderr, "Unknown subscriber_overflow '%s' (expected \"drop\" or \"disconnect\")\n", overflowPolicy);
+            config_destroy(&cfg);
+            exit(EXT_ERR_CONFIG_FILE);
+        }
+    }
+
+    int syncIntervalMs = 0;
+    if (config_lookup_int(&cfg, "log_sync_interval_ms", &syncIntervalMs)) { // 로그 fdatasync 주기 읽기
+        logSyncIntervalMs = syncIntervalMs;
+    }
+
+    int echo = 0;
+    if (config_lookup_bool(&cfg, "echo_events", &echo)) { // 로그 줄을 표준 출력에도 쓸지 여부 읽기
+        echoEvents = echo;
+    }
+
+    int headlessMode = 0;
+    if (config_lookup_bool(&cfg, "headless", &headlessMode)) { // 헤드리스 모드 여부 읽기
+        headless = headlessMode;
+    }
+
+    int rescan = 1;
+    if (config_lookup_bool(&cfg, "overflow_rescan", &rescan)) { // 오버플로 재검사 사용 여부 읽기
+        overflowRescan = rescan;
+    }
+
+    int threads = 0;
+    if (config_lookup_int(&cfg, "crawl_threads", &threads)) { // 초기 탐색 스레드 수 읽기
+        crawlThreads = threads;
+    }
+
+    int windowMs = 0;
+    if (config_lookup_int(&cfg, "coalesce_window_ms", &windowMs)) { // 이벤트 병합 시간 창 읽기
+        coalesceWindowMs = windowMs < 0 ? 0 : windowMs;
+    }
+
+    const char* filterExt = NULL;
+    if (config_lookup_string(&cfg, "filtered_extension", &filterExt)) { // 필터링할 확장자 읽기
+        strncpy(filteredExtension, filterExt, sizeof(filteredExtension)); // 필터링 확장자 저장
+    }
+
+    config_setting_t* directories = config_lookup(&cfg, "monitor_directories"); // 디렉토리 목록 읽기
+    if (directories) {
+        if (config_setting_is_array(directories)) { // 'monitor_directories'가 배열인지 확인
+            int count = config_setting_length(directories); // 배열의 길이 (디렉토리 개수)
+            for (int i = 0; i < count && i < 512; ++i) { // 디렉토리 경로를 배열에 저장
+                const char* dir = config_setting_get_string_elem(directories, i);
+                strncpy(monitoredDirs[i], dir, 512); // 디렉토리 경로 저장
+            }
+            *dirCount = count; // 디렉토리 개수 설정
+        }
+        else {
+            fprintf(stderr, "'monitor_directories' must be an array in config file\n");
+            config_destroy(&cfg); // 설정 객체 해제
+            exit(EXT_ERR_CONFIG_FILE); // 배열이 아니면 종료
+        }
+    }
+    else {
+        fprintf(stderr, "Missing 'monitor_directories' in config file\n");
+        config_destroy(&cfg); // 설정 객체 해제
+        exit(EXT_ERR_CONFIG_FILE); // 디렉토리가 없으면 종료
+    }
+
+    config_destroy(&cfg); // 설정 객체 해제
+}
+
+void coalesce_event(int wd, const char* name, uint32_t mask, int64_t eventTimeNs, int64_t nowMs);
+int64_t realtime_ns();
+int has_filtered_extension(const char* filename);
+
+// 작업 덱 초기화
+int crawl_deque_init(CrawlDeque* deque) {
+    pthread_mutex_init(&deque->lock, NULL);
+    deque->items = malloc(CRAWL_DEQUE_INITIAL_CAPACITY * sizeof(CrawlItem));
+    deque->head = deque->tail = 0;
+    deque->capacity = CRAWL_DEQUE_INITIAL_CAPACITY;
+    return deque->items ? 0 : -1;
+}
+
+// 소유 스레드: 덱 끝에 작업 추가 (가득 차면 두 배로 확장)
+int crawl_deque_push(CrawlDeque* deque, CrawlItem item) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail - deque->head == deque->capacity) {
+        CrawlItem* items = malloc(deque->capacity * 2 * sizeof(CrawlItem));
+        if (!items) {
+            pthread_mutex_unlock(&deque->lock);
+            return -1;
+        }
+        for (size_t i = deque->head; i != deque->tail; ++i) {
+            items[i & (deque->capacity * 2 - 1)] = deque->items[i & (deque->capacity - 1)];
+        }
+        free(deque->items);
+        deque->items = items;
+        deque->capacity *= 2;
+    }
+    deque->items[deque->tail & (deque->capacity - 1)] = item;
+    deque->tail++;
+    pthread_mutex_unlock(&deque->lock);
+    return 0;
+}
+
+// 소유 스레드: 가장 최근에 넣은 작업 꺼내기
+bool crawl_deque_pop(CrawlDeque* deque, CrawlItem* item) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->tail != deque->head;
+    if (found) {
+        deque->tail--;
+        *item = deque->items[deque->tail & (deque->capacity - 1)];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// 다른 스레드: 가장 오래된 작업 훔치기 (트리 위쪽의 큰 작업일 가능성이 높음)
+bool crawl_deque_steal(CrawlDeque* deque, CrawlItem* item) {
+    if (pthread_mutex_trylock(&deque->lock) != 0) return false;
+    bool found = deque->tail != deque->head;
+    if (found) {
+        *item = deque->items[deque->head & (deque->capacity - 1)];
+        deque->head++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+// 탐색 상태 해제
+void crawl_destroy(Crawl* crawl) {
+    for (int i = 0; i < crawl->workerCount; ++i) {
+        pthread_mutex_destroy(&crawl->deques[i].lock);
+        free(crawl->deques[i].items);
+    }
+    free(crawl->deques);
+    pthread_mutex_destroy(&crawl->workLock);
+    pthread_cond_destroy(&crawl->workAvailable);
+    pthread_mutex_destroy(&crawl->sliceLock);
+    pthread_cond_destroy(&crawl->sliceStart);
+    pthread_cond_destroy(&crawl->sliceDone);
+    free(crawl);
+}
+
+// 탐색 상태 생성
+Crawl* crawl_create(int workerCount, bool dynamic) {
+    Crawl* crawl = calloc(1, sizeof(Crawl));
+    if (!crawl) return NULL;
+    crawl->deques = calloc((size_t)workerCount, sizeof(CrawlDeque));
+    if (!crawl->deques) {
+        free(crawl);
+        return NULL;
+    }
+    crawl->workerCount = workerCount;
+    crawl->dynamic = dynamic;
+    crawl->startMs = monotonic_ms();
+
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC); // 시간 조각 마감 시각까지 기다림
+    pthread_mutex_init(&crawl->workLock, NULL);
+    pthread_cond_init(&crawl->workAvailable, &attributes);
+    pthread_condattr_destroy(&attributes);
+    pthread_mutex_init(&crawl->sliceLock, NULL);
+    pthread_cond_init(&crawl->sliceStart, NULL);
+    pthread_cond_init(&crawl->sliceDone, NULL);
+
+    // 실패해도 모든 덱을 초기화해 두어야 crawl_destroy로 정리할 수 있음
+    bool allocated = true;
+    for (int i = 0; i < workerCount; ++i) {
+        if (crawl_deque_init(&crawl->deques[i]) == -1) allocated = false;
+    }
+    if (!allocated) {
+        crawl_destroy(crawl);
+        return NULL;
+    }
+    return crawl;
+}
+
+// 디렉토리 하나의 처리를 마침 (마지막이면 작업을 기다리는 스레드를 깨워서 끝냄)
+void crawl_finish_item(Crawl* crawl) {
+    if (__atomic_sub_fetch(&crawl->outstanding, 1, __ATOMIC_SEQ_CST) == 0) {
+        pthread_mutex_lock(&crawl->workLock);
+        pthread_cond_broadcast(&crawl->workAvailable);
+        pthread_mutex_unlock(&crawl->workLock);
+    }
+}
+
+// 훔쳐 갈 작업이 있는 덱이 있는지 확인
+bool crawl_has_work(Crawl* crawl) {
+    bool found = false;
+    for (int i = 0; !found && i < crawl->workerCount; ++i) {
+        pthread_mutex_lock(&crawl->deques[i].lock);
+        found = crawl->deques[i].tail != crawl->deques[i].head;
+        pthread_mutex_unlock(&crawl->deques[i].lock);
+    }
+    return found;
+}
+
+// 다른 스레드가 하위 디렉토리를 내놓거나, 모든 디렉토리 처리가 끝나거나, 시간 조각이 끝날 때까지 대기
+void crawl_wait_for_work(Crawl* crawl) {
+    pthread_mutex_lock(&crawl->workLock);
+    while (!crawl_has_work(crawl) && __atomic_load_n(&crawl->outstanding, __ATOMIC_SEQ_CST) != 0) {
+        if (!crawl->sliced) {
+            pthread_cond_wait(&crawl->workAvailable, &crawl->workLock);
+            continue;
+        }
+        if (monotonic_ms() >= crawl->sliceEndMs) break;
+        struct timespec until = { (time_t)(crawl->sliceEndMs / 1000), (long)(crawl->sliceEndMs % 1000) * 1000000 };
+        pthread_cond_timedwait(&crawl->workAvailable, &crawl->workLock, &until);
+    }
+    pthread_mutex_unlock(&crawl->workLock);
+}
+
+// 디렉토리를 열고 감시를 건 뒤 노드를 등록하여 탐색 덱에 추가
+// dirFd 기준 상대 경로 openName을 열고, 노드 이름은 nodeName (루트이면 전체 경로)
+// 반환값: 0 성공, 1 이미 감시 중, -1 실패
+int crawl_register_directory(Crawl* crawl, int deque, int dirFd, const char* openName,
+                             uint32_t parent, const char* nodeName) {
+    int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+    if (parent != WATCH_NODE_NONE) flags |= O_NOFOLLOW; // 설정된 루트 외에는 심볼릭 링크를 따라가지 않음
+    int fd = openat(dirFd, openName, flags);
+    if (fd == -1) {
+        if (errno != ENOENT) fprintf(stderr, "Error opening directory %s: %s\n", openName, strerror(errno));
+        return -1;
+    }
+
+    // 경로 문자열을 만들지 않고 열린 fd로 감시 추가
+    char fdPath[64];
+    snprintf(fdPath, sizeof(fdPath), "/proc/self/fd/%d", fd);
+    int wd = inotify_add_watch(IeventQueue, fdPath, WATCH_MASK);
+    if (wd == -1) {
+        fprintf(stderr, "Error adding watch for %s: %s\n", openName, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    int node = add_watch_node(wd, parent, nodeName);
+    if (node < 0) {
+        if (node == -1) {
+            fprintf(stderr, "Error storing watch for %s\n", openName);
+            inotify_rm_watch(IeventQueue, wd);
+        }
+        close(fd);
+        return node == -2 ? 1 : -1;
+    }
+    __atomic_add_fetch(&crawl->directories, 1, __ATOMIC_RELAXED);
+
+    if (crawl->sliced) { // 항목을 읽기 전에는 오버플로 재검사에서 제외 (모든 항목이 새로 생긴 것으로 보이지 않도록)
+        pthread_mutex_lock(&watchTableLock);
+        watchNodes[node].flags |= WATCH_NODE_CRAWL_PENDING;
+        pthread_mutex_unlock(&watchTableLock);
+    }
+
+    // 열린 fd가 너무 많으면 닫고, 처리할 때 노드 경로로 다시 염
+    if (__atomic_add_fetch(&crawl->openFds, 1, __ATOMIC_RELAXED) > CRAWL_MAX_OPEN_FDS) {
+        __atomic_sub_fetch(&crawl->openFds, 1, __ATOMIC_RELAXED);
+        close(fd);
+        fd = -1;
+    }
+
+    CrawlItem item = { fd, (uint32_t)node, wd };
+    __atomic_add_fetch(&crawl->outstanding, 1, __ATOMIC_SEQ_CST);
+    if (crawl_deque_push(&crawl->deques[deque], item) == -1) {
+        fprintf(stderr, "Error queueing directory %s\n", openName);
+        crawl_finish_item(crawl);
+        if (fd != -1) {
+            __atomic_sub_fetch(&crawl->openFds, 1, __ATOMIC_RELAXED);
+            close(fd);
+        }
+        return -1;
+    }
+
+    // 작업을 기다리는 스레드 하나를 깨움 (대기 쪽은 같은 잠금 안에서 덱을 확인하므로 알림을 놓치지 않음)
+    pthread_mutex_lock(&crawl->workLock);
+    pthread_cond_signal(&crawl->workAvailable);
+    pthread_mutex_unlock(&crawl->workLock);
+    return 0;
+}
+
+// 디렉토리 하나를 getdents64로 읽고 하위 디렉토리를 등록
+void crawl_process_directory(Crawl* crawl, int workerId, CrawlItem item, char* buffer) {
+    char path[PATH_MAX] = "";
+    pthread_mutex_lock(&watchTableLock);
+    int wd = watchNodes[item.node].wd;
+    bool alive = wd == item.wd && !(watchNodes[item.node].flags & WATCH_NODE_DEAD); // 기다리는 동안 삭제되거나 밖으로 옮겨짐
+    if (alive) watch_build_path(item.node, path, sizeof(path));
+    pthread_mutex_unlock(&watchTableLock);
+
+    if (!alive) {
+        if (item.fd != -1) {
+            __atomic_sub_fetch(&crawl->openFds, 1, __ATOMIC_RELAXED);
+            close(item.fd);
+        }
+        return;
+    }
+
+    int fd = item.fd;
+    if (fd == -1) {
+        fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) {
+            fprintf(stderr, "Error opening directory %s: %s\n", path, strerror(errno));
+            return;
+        }
+    }
+    else {
+        __atomic_sub_fetch(&crawl->openFds, 1, __ATOMIC_RELAXED);
+    }
+
+    if (crawl->dynamic && !headless) {
+        post_directory_added(wd); // 디렉토리 목록 추가는 GTK 메인 스레드에서
+    }
+
+    uint64_t entryCount = 0;
+    for (;;) {
+        long readLength = syscall(SYS_getdents64, fd, buffer, CRAWL_DENTS_BUFFER_SIZE);
+        if (readLength == -1 && errno == EINTR) continue;
+        if (readLength == -1) {
+            fprintf(stderr, "Error reading directory %s: %s\n", path, strerror(errno));
+            break;
+        }
+        if (readLength == 0) break;
+
+        for (long offset = 0; offset < readLength;) {
+            struct linux_dirent64* entry = (struct linux_dirent64*)(buffer + offset);
+            offset += entry->d_reclen;
+
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+                continue; // 현재 디렉토리와 부모 디렉토리는 무시
+            }
+            entryCount++;
+
+            // d_type을 알 수 없는 파일 시스템에서만 fstatat 호출 (심볼릭 링크는 따라가지 않음)
+            unsigned char type = entry->d_type;
+            if (type == DT_UNKNOWN) {
+                struct stat pathStat;
+                if (fstatat(fd, name, &pathStat, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(pathStat.st_mode)) {
+                    type = DT_DIR;
+                }
+                entry->d_type = type; // 항목 집합 기록 단계에서 다시 사용
+            }
+
+            // 감시가 걸리기 전에 생긴 항목은 생성 이벤트로 보냄 (실제 이벤트와는 병합 단계에서 합쳐짐)
+            if (crawl->dynamic && !has_filtered_extension(name)) {
+                coalesce_event(wd, name, IN_CREATE | (type == DT_DIR ? IN_ISDIR : 0), realtime_ns(), monotonic_ms());
+            }
+
+            if (type == DT_DIR) {
+                crawl_register_directory(crawl, workerId, fd, name, item.node, name);
+            }
+        }
+
+        // 오버플로 재검사 비교를 위해 읽은 파일 이름을 한 번의 잠금으로 기록
+        if (overflowRescan) {
+            pthread_mutex_lock(&watchTableLock);
+            for (long offset = 0; offset < readLength;) {
+                struct linux_dirent64* entry = (struct linux_dirent64*)(buffer + offset);
+                offset += entry->d_reclen;
+
+                const char* name = entry->d_name;
+                if (entry->d_type == DT_DIR || (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))) {
+                    continue;
+                }
+                uint32_t nameId = intern_name(name);
+                if (nameId != NAME_NONE) entry_set_add(&watchNodes[item.node].entries, nameId);
+            }
+            pthread_mutex_unlock(&watchTableLock);
+        }
+    }
+    __atomic_add_fetch(&crawl->entries, entryCount, __ATOMIC_RELAXED);
+
+    pthread_mutex_lock(&watchTableLock);
+    watchNodes[item.node].flags &= ~(uint32_t)WATCH_NODE_CRAWL_PENDING;
+    if (crawl->sliced && watchNodes[item.node].listed) { // 목록에 보이는 디렉토리면 하위 디렉토리를 바로 반영
+        for (uint32_t child = watchNodes[item.node].firstChild; child != WATCH_NODE_NONE; child = watchNodes[child].nextSibling) {
+            post_directory_added(watchNodes[child].wd);
+        }
+    }
+    pthread_mutex_unlock(&watchTableLock);
+
+    close(fd);
+}
+
+// 시간 조각을 마치고 감시 스레드가 다음 조각을 열 때까지 대기 (중단 요청이면 false)
+bool crawl_wait_for_slice(Crawl* crawl, uint32_t* slice) {
+    pthread_mutex_lock(&crawl->sliceLock);
+    if (*slice != 0) {
+        crawl->parked++;
+        pthread_cond_signal(&crawl->sliceDone);
+    }
+    while (crawl->slice == *slice && !crawl->stopping) {
+        pthread_cond_wait(&crawl->sliceStart, &crawl->sliceLock);
+    }
+    *slice = crawl->slice;
+    bool running = !crawl->stopping;
+    pthread_mutex_unlock(&crawl->sliceLock);
+    return running;
+}
+
+// 탐색 스레드: 자신의 덱을 먼저 비우고, 비면 다른 스레드의 덱에서 훔침
+void* crawl_worker(void* arg) {
+    CrawlWorker* worker = arg;
+    Crawl* crawl = worker->crawl;
+
+    char* buffer = malloc(CRAWL_DENTS_BUFFER_SIZE);
+    if (!buffer) {
+        fprintf(stderr, "Error allocating crawl buffer\n");
+    }
+
+    uint32_t slice = 0;
+    bool running = buffer && (!crawl->sliced || crawl_wait_for_slice(crawl, &slice)); // 첫 시간 조각 대기
+    while (running) {
+        if (crawl->sliced && monotonic_ms() >= crawl->sliceEndMs && !crawl_wait_for_slice(crawl, &slice)) {
+            break;
+        }
+
+        CrawlItem item;
+        bool found = crawl_deque_pop(&crawl->deques[worker->id], &item);
+        for (int i = 1; !found && i < crawl->workerCount; ++i) {
+            found = crawl_deque_steal(&crawl->deques[(worker->id + i) % crawl->workerCount], &item);
+        }
+
+        if (found) {
+            crawl_process_directory(crawl, worker->id, item, buffer);
+            crawl_finish_item(crawl);
+        }
+        else if (__atomic_load_n(&crawl->outstanding, __ATOMIC_SEQ_CST) == 0) {
+            break; // 모든 디렉토리 처리 완료
+        }
+        else {
+            crawl_wait_for_work(crawl);
+        }
+    }
+
+    if (crawl->sliced) {
+        pthread_mutex_lock(&crawl->sliceLock);
+        crawl->exited++;
+        pthread_cond_signal(&crawl->sliceDone);
+        pthread_mutex_unlock(&crawl->sliceLock);
+    }
+    free(buffer);
+    return NULL;
+}
+
+Crawl* rootCrawl = NULL;              // 진행 중인 초기 탐색 (감시 스레드가 시간 조각을 나눠 줌, 끝나면 NULL)
+pthread_t rootCrawlThreads[CRAWL_MAX_THREADS];
+CrawlWorker rootCrawlWorkers[CRAWL_MAX_THREADS];
+CrawlProgress crawlProgress;          // 초기 탐색 진행 상황
+
+// 설정된 루트 디렉토리에 감시를 걸고 탐색 스레드 시작 (하위 트리는 감시 루프가 시간 조각으로 나눠 탐색)
+void start_root_crawl(char monitoredDirs[][512], int dirCount) {
+    int workerCount = crawlThreads > 0 ? crawlThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (workerCount < 1) workerCount = 1;
+    if (workerCount > CRAWL_MAX_THREADS) workerCount = CRAWL_MAX_THREADS;
+
+    Crawl* crawl = crawl_create(workerCount, false);
+    if (!crawl) {
+        fprintf(stderr, "Error allocating crawl state\n");
+        __atomic_store_n(&crawlProgress.finished, 1, __ATOMIC_RELEASE);
+        return;
+    }
+    crawl->sliced = true;
+
+    for (int i = 0; i < dirCount; ++i) {
+        crawl_register_directory(crawl, i % workerCount, AT_FDCWD, monitoredDirs[i], WATCH_NODE_NONE, monitoredDirs[i]);
+    }
+
+    for (int i = 0; i < workerCount; ++i) {
+        rootCrawlWorkers[i].crawl = crawl;
+        rootCrawlWorkers[i].id = i;
+        pthread_create(&rootCrawlThreads[i], NULL, crawl_worker, &rootCrawlWorkers[i]);
+    }
+    rootCrawl = crawl;
+}
+
+// 탐색 스레드를 모두 끝내고 초기 탐색 상태 해제
+void finish_root_crawl() {
+    Crawl* crawl = rootCrawl;
+    pthread_mutex_lock(&crawl->sliceLock);
+    crawl->stopping = true; // 멈춰 있는 스레드를 깨워서 끝냄
+    pthread_cond_broadcast(&crawl->sliceStart);
+    pthread_mutex_unlock(&crawl->sliceLock);
+    for (int i = 0; i < crawl->workerCount; ++i) {
+        pthread_join(rootCrawlThreads[i], NULL);
+    }
+
+    // 중단된 경우 덱에 남은 디렉토리 fd 닫기
+    for (int i = 0; i < crawl->workerCount; ++i) {
+        CrawlItem item;
+        while (crawl_deque_pop(&crawl->deques[i], &item)) {
+            if (item.fd != -1) close(item.fd);
+        }
+    }
+    crawl_destroy(crawl);
+    rootCrawl = NULL;
+    __atomic_store_n(&crawlProgress.finished, 1, __ATOMIC_RELEASE);
+}
+
+// 초기 탐색을 시간 조각 하나만큼 진행 (감시 스레드에서 호출, 그동안 이벤트 처리는 멈춤)
+void continue_root_crawl() {
+    Crawl* crawl = rootCrawl;
+    if (!crawl) return;
+
+    pthread_mutex_lock(&crawl->sliceLock);
+    crawl->parked = 0;
+    crawl->sliceEndMs = monotonic_ms() + CRAWL_SLICE_MS;
+    crawl->slice++;
+    pthread_cond_broadcast(&crawl->sliceStart);
+    while (crawl->parked + crawl->exited < crawl->workerCount) {
+        pthread_cond_wait(&crawl->sliceDone, &crawl->sliceLock);
+    }
+    bool finished = crawl->exited == crawl->workerCount;
+    pthread_mutex_unlock(&crawl->sliceLock);
+
+    int64_t elapsedMs = monotonic_ms() - crawl->startMs;
+    __atomic_store_n(&crawlProgress.directories, crawl->directories, __ATOMIC_RELAXED);
+    __atomic_store_n(&crawlProgress.entries, crawl->entries, __ATOMIC_RELAXED);
+    __atomic_store_n(&crawlProgress.queued, (uint64_t)crawl->outstanding, __ATOMIC_RELAXED);
+    __atomic_store_n(&crawlProgress.elapsedMs, elapsedMs, __ATOMIC_RELAXED);
+    if (!finished) return;
+
+    double seconds = (double)elapsedMs / 1000.0;
+    if (seconds <= 0) seconds = 0.001;
+    printf("Crawl finished: %llu directories, %llu entries in %.2f s (%.0f dirs/s, %.0f entries/s, %d threads)\n",
+           (unsigned long long)crawl->directories, (unsigned long long)crawl->entries, seconds,
+           (double)crawl->directories / seconds, (double)crawl->entries / seconds, crawl->workerCount);
+    finish_root_crawl();
+}
+
+// 초기 탐색 진행 상황을 디렉토리 목록 제목 아래에 표시 (GTK 타이머, 탐색이 끝나면 멈춤)
+gboolean update_crawl_progress(gpointer data) {
+    int finished = __atomic_load_n(&crawlProgress.finished, __ATOMIC_ACQUIRE);
+    uint64_t directories = __atomic_load_n(&crawlProgress.directories, __ATOMIC_RELAXED);
+    uint64_t queued = __atomic_load_n(&crawlProgress.queued, __ATOMIC_RELAXED);
+    int64_t elapsedMs = __atomic_load_n(&crawlProgress.elapsedMs, __ATOMIC_RELAXED);
+
+    char status[160];
+    if (finished) {
+        snprintf(status, sizeof(status), "%llu directories", (unsigned long long)directories);
+        gtk_header_bar_set_subtitle(GTK_HEADER_BAR(directoryHeader), status);
+        return FALSE;
+    }
+
+    // 남은 시간은 이미 찾은 디렉토리만으로 계산하므로 최소 추정치
+    double rate = elapsedMs > 0 ? (double)directories * 1000.0 / (double)elapsedMs : 0;
+    if (rate > 0) {
+        snprintf(status, sizeof(status), "Crawling: %llu directories (%.0f dirs/s), %llu queued, at least %.0f s left",
+                 (unsigned long long)directories, rate, (unsigned long long)queued, (double)queued / rate);
+    }
+    else {
+        snprintf(status, sizeof(status), "Crawling...");
+    }
+    gtk_header_bar_set_subtitle(GTK_HEADER_BAR(directoryHeader), status);
+    return TRUE;
+}
+
+// 시작 후 새로 생긴 디렉토리 트리를 감시 스레드에서 탐색 (변경된 하위 트리 크기에 비례)
+void crawl_new_directory(const char* path, uint32_t parent, const char* name) {
+    Crawl* crawl = crawl_create(1, true);
+    if (!crawl) {
+        fprintf(stderr, "Error allocating crawl state\n");
+        return;
+    }
+
+    if (crawl_register_directory(crawl, 0, AT_FDCWD, path, parent, name) == 0) {
+        CrawlWorker worker = { crawl, 0 };
+        crawl_worker(&worker);
+    }
+    crawl_destroy(crawl);
+}
+
+// watch descriptor를 경로로 변환하는 함수 (buffer에 전체 경로를 조립)
+const char* get_path_from_wd(int wd, char* buffer, size_t bufferSize) {
+    int node = find_watch_by_wd(wd); // 해시 인덱스에서 O(1)로 조회
+    if (node >= 0 && watch_build_path((uint32_t)node, buffer, bufferSize) >= 0) {
+        return buffer;
+    }
+    return NULL; // 경로를 찾지 못한 경우 (이미 해제된 wd)
+}
+
+// 파일 확장자 필터링 함수
+int has_filtered_extension(const char* filename) {
+    if (strlen(filteredExtension) == 0) return 0;  // 필터링할 확장자가 없으면 모두 허용
+
+    const char* ext = strrchr(filename, '.');  // 파일 확장자 찾기
+    if (ext != NULL && strcmp(ext + 1, filteredExtension) == 0) {
+        return 1;  // 필터링 확장자와 일치하면 1 반환
+    }
+
+    return 0;  // 확장자가 일치하지 않으면 0 반환
+}
+
+// 필터링 확장자 확인 함수 (한 번만 출력)
+void check_filtered_extension() {
+    if (strlen(filteredExtension) > 0) {
+        printf("Filtering files with extension: .%s\n", filteredExtension); // 필터링 확장자 출력
+    }
+    else {
+        printf("No extensions are filtered\n"); // 필터링 확장자가 없으면 출력
+    }
+}
+
+// 단조 증가 시계 (밀리초)
+int64_t monotonic_ms() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// 현재 시각 (CLOCK_REALTIME, 나노초)
+int64_t realtime_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// 이벤트 묶음을 읽은 직후 시각을 한 번만 기록
+void sample_event_clock() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    batchClock.realtimeNs = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    batchClock.monotonicNs = (int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// 병합 대기 항목 저장 공간 초기화
+int init_coalescer() {
+    pendingPool = calloc(COALESCE_MAX_PENDING, sizeof(PendingEvent));
+    if (!pendingPool) return -1;
+
+    for (int i = COALESCE_MAX_PENDING - 1; i >= 0; --i) {
+        pendingPool[i].nextInQueue = pendingFreeList;
+        pendingFreeList = &pendingPool[i];
+    }
+    return 0;
+}
+
+// (wd, name) 해시 (FNV-1a)
+uint32_t pending_hash(int wd, const char* name) {
+    uint32_t hash = 2166136261u ^ (uint32_t)wd;
+    hash *= 16777619u;
+    for (const unsigned char* c = (const unsigned char*)name; *c; ++c) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash & (COALESCE_BUCKETS - 1);
+}
+
+// 여러 이벤트를 하나의 최종 이벤트 마스크로 합침
+uint32_t pending_net_mask(const PendingEvent* pending) {
+    bool existedBefore = !(pending->firstMask & IN_CREATE); // 창 시작 전에 파일이 있었는지
+    bool existsNow = !(pending->lastMask & IN_DELETE);      // 창 끝에 파일이 있는지
+    uint32_t otherBits = pending->seenMask & ~(uint32_t)(IN_CREATE | IN_DELETE | IN_MODIFY);
+
+    if (!existedBefore && existsNow) return IN_CREATE | otherBits;
+    if (!existedBefore && !existsNow) return IN_CREATE | IN_DELETE | otherBits; // 잠깐 생겼다 사라진 파일
+    if (existedBefore && !existsNow) return IN_DELETE | otherBits;
+    if (pending->seenMask & (IN_CREATE | IN_DELETE | IN_MODIFY)) return IN_MODIFY | otherBits; // 수정 또는 교체
+    return pending->seenMask;
+}
+
+// 디렉토리 wd와 이름으로 전체 경로 생성 (잘린 경우 -1, 감시하지 않는 wd이면 -2)
+int build_event_path(int wd, const char* name, char* buffer, size_t bufferSize) {
+    char basePath[PATH_MAX];
+    if (!get_path_from_wd(wd, basePath, sizeof(basePath))) { // watch descriptor에 해당하는 경로 얻기
+        buffer[0] = '\0';
+        return -2;
+    }
+    int length = snprintf(buffer, bufferSize, "%s/%s", basePath, name); // 전체 경로 생성
+    if (length >= (int)bufferSize) {
+        fprintf(stderr, "Event path truncated: %s/%s\n", basePath, name);
+        return -1;
+    }
+    return length;
+}
+
+// 완성된 이벤트를 로그, 사운드, UI로 전달
+void dispatch_event(EventRecord* record) {
+    int node = find_watch_by_wd(record->wd);
+    if (node >= 0 && !headless) {
+        queue_highlight(node); // GTK 호출은 다음 UI 프레임에서 메인 스레드가 함
+    }
+
+    log_event(record); // 로그에 이벤트 기록
+    if (!headless) event_sound();
+}
+
+// 병합이 끝난 이벤트를 전달
+void emit_coalesced_event(const PendingEvent* pending) {
+    EventRecord record; // UI와 로그로 전달할 이벤트 레코드
+    record.eventTimeNs = pending->firstTimeNs;
+    record.mask = pending_net_mask(pending);
+    record.wd = pending->wd;
+    record.count = pending->count;
+    record.oldPathOffset = 0;
+    if (build_event_path(pending->wd, pending->name, record.path, sizeof(record.path)) == -2) {
+        return; // 그 사이 감시가 해제된 디렉토리의 이벤트는 버림
+    }
+
+    dispatch_event(&record);
+}
+
+// 대기 항목을 큐와 해시 테이블에서 제거하고 내보냄
+void flush_pending(PendingEvent* pending) {
+    if (pending->prevInQueue) pending->prevInQueue->nextInQueue = pending->nextInQueue;
+    else pendingQueueHead = pending->nextInQueue;
+    if (pending->nextInQueue) pending->nextInQueue->prevInQueue = pending->prevInQueue;
+    else pendingQueueTail = pending->prevInQueue;
+
+    PendingEvent** link = &pendingBuckets[pending_hash(pending->wd, pending->name)];
+    while (*link != pending) link = &(*link)->nextInBucket;
+    *link = pending->nextInBucket;
+
+    emit_coalesced_event(pending);
+
+    pending->nextInQueue = pendingFreeList;
+    pendingFreeList = pending;
+}
+
+// 특정 (wd, name)의 대기 항목이 있으면 즉시 내보냄 (이름 변경 전후 순서 유지용)
+void flush_pending_key(int wd, const char* name) {
+    for (PendingEvent* pending = pendingBuckets[pending_hash(wd, name)]; pending; pending = pending->nextInBucket) {
+        if (pending->wd == wd && strcmp(pending->name, name) == 0) {
+            flush_pending(pending);
+            return;
+        }
+    }
+}
+
+// 큐의 가장 오래된 항목을 내보냄
+void flush_oldest_pending() {
+    flush_pending(pendingQueueHead);
+}
+
+// 병합 창이 끝난 항목을 모두 내보냄 (force이면 전부)
+void flush_coalesced_events(int64_t nowMs, bool force) {
+    while (pendingQueueHead && (force || pendingQueueHead->deadlineMs <= nowMs)) {
+        flush_oldest_pending();
+    }
+}
+
+// 다음 병합 창 마감 또는 노드 해제까지 남은 시간 (epoll_wait 타임아웃, 할 일이 없으면 -1)
+int next_event_loop_timeout(int64_t nowMs) {
+    int64_t deadline = INT64_MAX;
+    if (pendingQueueHead) deadline = pendingQueueHead->deadlineMs;
+    if (retiredHead < retiredCount && retiredWatches[retiredHead].releaseMs < deadline) {
+        deadline = retiredWatches[retiredHead].releaseMs;
+    }
+    if (pendingMoveHead != pendingMoveTail && pendingMoves[pendingMoveHead % MOVE_PAIR_MAX].deadlineMs < deadline) {
+        deadline = pendingMoves[pendingMoveHead % MOVE_PAIR_MAX].deadlineMs;
+    }
+    if (rescanHead < rescanCount) return 0; // 재검사가 남아 있으면 기다리지 않음
+    if (rootCrawl) return 0;                 // 초기 탐색 중이면 이벤트만 확인하고 다음 시간 조각으로
+    if (deadline == INT64_MAX) return -1;
+
+    int64_t remaining = deadline - nowMs;
+    return remaining > 0 ? (int)remaining : 0;
+}
+
+// 이벤트를 (wd, name) 별 대기 항목에 병합
+void coalesce_event(int wd, const char* name, uint32_t mask, int64_t eventTimeNs, int64_t nowMs) {
+    uint32_t bucket = pending_hash(wd, name);
+    for (PendingEvent* pending = pendingBuckets[bucket]; pending; pending = pending->nextInBucket) {
+        if (pending->wd == wd && strcmp(pending->name, name) == 0) {
+            pending->lastMask = mask;
+            pending->seenMask |= mask;
+            pending->count++;
+            return;
+        }
+    }
+
+    if (!pendingFreeList) {
+        flush_oldest_pending(); // 대기 항목이 가득 차면 가장 오래된 항목을 먼저 내보냄 (유실 없음)
+    }
+
+    PendingEvent* pending = pendingFreeList;
+    pendingFreeList = pending->nextInQueue;
+
+    pending->wd = wd;
+    pending->firstMask = pending->lastMask = pending->seenMask = mask;
+    pending->count = 1;
+    pending->firstTimeNs = eventTimeNs;
+    pending->deadlineMs = nowMs + coalesceWindowMs;
+    strncpy(pending->name, name, sizeof(pending->name) - 1);
+    pending->name[sizeof(pending->name) - 1] = '\0';
+
+    pending->nextInBucket = pendingBuckets[bucket];
+    pendingBuckets[bucket] = pending;
+
+    pending->nextInQueue = NULL;
+    pending->prevInQueue = pendingQueueTail;
+    if (pendingQueueTail) pendingQueueTail->nextInQueue = pending;
+    else pendingQueueHead = pending;
+    pendingQueueTail = pending;
+}
+
+// 새로 생긴 디렉토리와 그 하위 트리에 감시 추가
+void watch_new_directory(int parentWd, const char* name) {
+    if (useFanotify) return; // 파일 시스템 전체를 표시했으므로 디렉토리별 감시가 필요 없음
+
+    int parent = find_watch_by_wd(parentWd);
+    if (parent < 0 || (watchNodes[parent].flags & WATCH_NODE_DEAD)) return;
+
+    char path[PATH_MAX];
+    int length = watch_build_path((uint32_t)parent, path, sizeof(path));
+    if (length < 0 || snprintf(path + length, sizeof(path) - (size_t)length, "/%s", name) >= (int)(sizeof(path) - (size_t)length)) {
+        fprintf(stderr, "Path too long, not watching new directory %s\n", name);
+        return;
+    }
+    crawl_new_directory(path, (uint32_t)parent, name);
+}
+
+// 이벤트에 따라 디렉토리의 마지막 알려진 항목 집합 갱신 (하위 디렉토리는 노드로 관리)
+void track_directory_entry(int wd, const char* name, uint32_t mask, bool present) {
+    if (!overflowRescan || (mask & IN_ISDIR)) return;
+
+    int node = find_watch_by_wd(wd);
+    if (node < 0) return;
+
+    pthread_mutex_lock(&watchTableLock);
+    if (present) {
+        uint32_t nameId = intern_name(name);
+        if (nameId != NAME_NONE) entry_set_add(&watchNodes[node].entries, nameId);
+    }
+    else {
+        uint32_t nameId = find_name(name);
+        if (nameId != NAME_NONE) entry_set_remove(&watchNodes[node].entries, nameId);
+    }
+    pthread_mutex_unlock(&watchTableLock);
+}
+
+// 재검사 우선순위를 위해 최근 이벤트가 발생한 디렉토리 기록
+void note_recent_activity(int wd) {
+    int node = find_watch_by_wd(wd);
+    if (node < 0) return;
+    if (recentNodeCount > 0 && recentNodes[(recentNodeCount - 1) % RECENT_ACTIVITY_MAX] == (uint32_t)node) return;
+    recentNodes[recentNodeCount % RECENT_ACTIVITY_MAX] = (uint32_t)node;
+    recentNodeCount++;
+}
+
+// 오버플로나 재검사 결과 같은 알림을 로그에 남김
+void log_notice(uint32_t mask, const char* text) {
+    EventRecord record;
+    record.eventTimeNs = realtime_ns();
+    record.mask = mask;
+    record.wd = -1;
+    record.count = 1;
+    record.oldPathOffset = 0;
+    snprintf(record.path, sizeof(record.path), "%s", text);
+    log_event(&record);
+}
+
+// 재검사 큐에 노드 추가 (이미 들어간 노드는 무시)
+void queue_rescan(uint32_t node) {
+    if (watchNodes[node].flags & (WATCH_NODE_DEAD | WATCH_NODE_RESCAN_QUEUED)) return;
+
+    if (rescanCount == rescanCapacity) {
+        size_t capacity = rescanCapacity ? rescanCapacity * 2 : 1024;
+        uint32_t* queue = realloc(rescanQueue, capacity * sizeof(uint32_t));
+        if (!queue) {
+            fprintf(stderr, "Error growing rescan queue\n");
+            return;
+        }
+        rescanQueue = queue;
+        rescanCapacity = capacity;
+    }
+    watchNodes[node].flags |= WATCH_NODE_RESCAN_QUEUED;
+    rescanQueue[rescanCount++] = node;
+}
+
+// 노드가 속한 루트 노드 찾기
+uint32_t watch_root_of(uint32_t node) {
+    while (watchNodes[node].parent != WATCH_NODE_NONE) node = watchNodes[node].parent;
+    return node;
+}
+
+// 큐 오버플로: 유실 구간을 기록하고 최근 활동이 많은 곳부터 재검사 예약
+void handle_queue_overflow() {
+    struct timespec gapStart = lastQueueDrainedTime; // 이 시각 이후의 이벤트가 유실되었을 수 있음
+    char gapText[64];
+    time_t gapSeconds = gapStart.tv_sec;
+    struct tm gapTime;
+    strftime(gapText, sizeof(gapText), "%Y-%m-%d %H:%M:%S", localtime_r(&gapSeconds, &gapTime));
+
+    if (!overflowRescan) {
+        char notice[256];
+        snprintf(notice, sizeof(notice), "events since %s were lost (rescan disabled)", gapText);
+        log_notice(IN_Q_OVERFLOW, notice);
+        return;
+    }
+
+    // 재검사 중에 다시 넘친 경우 가장 이른 유실 시각부터 처음부터 다시 검사
+    if (rescanHead < rescanCount && (rescanSince.tv_sec < gapStart.tv_sec ||
+        (rescanSince.tv_sec == gapStart.tv_sec && rescanSince.tv_nsec < gapStart.tv_nsec))) {
+        gapStart = rescanSince;
+    }
+    for (uint32_t node = 0; node < watchNodeCount; ++node) {
+        watchNodes[node].flags &= ~(uint32_t)WATCH_NODE_RESCAN_QUEUED;
+    }
+    rescanHead = rescanCount = 0;
+    rescanSince = gapStart;
+    rescanStartMs = monotonic_ms();
+    rescanDirectories = rescanDifferences = 0;
+
+    // 1순위: 최근 이벤트가 발생한 디렉토리 (최신 순)
+    size_t recent = recentNodeCount < RECENT_ACTIVITY_MAX ? recentNodeCount : RECENT_ACTIVITY_MAX;
+    for (size_t i = 0; i < recent; ++i) {
+        queue_rescan(recentNodes[(recentNodeCount - 1 - i) % RECENT_ACTIVITY_MAX]);
+    }
+
+    // 2순위: 최근 활동이 많은 루트 순서로 나머지 트리 (너비 우선, 처리하면서 자식을 추가)
+    uint32_t roots[512];
+    size_t rootActivity[512];
+    int rootCount = 0;
+    for (uint32_t node = 0; node < watchNodeCount && rootCount < 512; ++node) {
+        if (watchNodes[node].parent == WATCH_NODE_NONE && watchNodes[node].name != NAME_NONE &&
+            !(watchNodes[node].flags & WATCH_NODE_DEAD)) {
+            roots[rootCount] = node;
+            rootActivity[rootCount++] = 0;
+        }
+    }
+    for (size_t i = 0; i < recent; ++i) {
+        uint32_t root = watch_root_of(recentNodes[(recentNodeCount - 1 - i) % RECENT_ACTIVITY_MAX]);
+        for (int r = 0; r < rootCount; ++r) {
+            if (roots[r] == root) rootActivity[r]++;
+        }
+    }
+    for (int picked = 0; picked < rootCount; ++picked) {
+        int best = -1;
+        for (int r = 0; r < rootCount; ++r) {
+            if ((watchNodes[roots[r]].flags & WATCH_NODE_RESCAN_QUEUED) == 0 &&
+                (best < 0 || rootActivity[r] > rootActivity[best])) {
+                best = r;
+            }
+        }
+        if (best < 0) break;
+        queue_rescan(roots[best]);
+    }
+
+    char notice[256];
+    snprintf(notice, sizeof(notice), "events since %s may be lost, rescanning %d roots", gapText, rootCount);
+    log_notice(IN_Q_OVERFLOW, notice);
+}
+
+// 재검사로 찾은 차이를 합성 이벤트로 보냄
+void emit_rescan_difference(int wd, const char* name, uint32_t mask) {
+    rescanDifferences++;
+    if (!has_filtered_extension(name)) {
+        coalesce_event(wd, name, mask, realtime_ns(), monotonic_ms());
+    }
+}
+
+// 디렉토리 하나를 다시 읽어 마지막으로 알고 있는 상태와 비교
+void rescan_directory(uint32_t node, char* buffer, size_t bufferSize) {
+    if (watchNodes[node].flags & (WATCH_NODE_DEAD | WATCH_NODE_CRAWL_PENDING)) return; // 아직 탐색 전이면 탐색이 기록함
+
+    int wd = watchNodes[node].wd;
+    char path[PATH_MAX];
+    if (watch_build_path(node, path, sizeof(path)) < 0) return;
+
+    int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) return; // 삭제된 디렉토리는 부모를 재검사할 때 처리됨
+    rescanDirectories++;
+
+    EntrySet seenFiles = { NULL, 0, 0 };    // 지금 있는 파일
+    EntrySet seenDirectories = { NULL, 0, 0 }; // 지금 있는 하위 디렉토리
+
+    for (;;) {
+        long readLength = syscall(SYS_getdents64, fd, buffer, bufferSize);
+        if (readLength == -1 && errno == EINTR) continue;
+        if (readLength <= 0) break;
+
+        for (long offset = 0; offset < readLength;) {
+            struct linux_dirent64* entry = (struct linux_dirent64*)(buffer + offset);
+            offset += entry->d_reclen;
+
+            const char* name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+            struct stat pathStat;
+            bool haveStat = false;
+            unsigned char type = entry->d_type;
+            if (type == DT_UNKNOWN || type == DT_REG) {
+                haveStat = fstatat(fd, name, &pathStat, AT_SYMLINK_NOFOLLOW) == 0;
+                if (haveStat && S_ISDIR(pathStat.st_mode)) type = DT_DIR;
+            }
+
+            pthread_mutex_lock(&watchTableLock);
+            uint32_t nameId = intern_name(name);
+            bool known = false;
+            if (nameId != NAME_NONE) {
+                if (type == DT_DIR) {
+                    entry_set_add(&seenDirectories, nameId);
+                    known = find_child_watch(node, nameId) >= 0;
+                }
+                else {
+                    entry_set_add(&seenFiles, nameId);
+                    known = entry_set_contains(&watchNodes[node].entries, nameId);
+                    if (!known) entry_set_add(&watchNodes[node].entries, nameId);
+                }
+            }
+            pthread_mutex_unlock(&watchTableLock);
+
+            if (type == DT_DIR) {
+                if (!known) { // 유실된 동안 생긴 디렉토리: 하위 트리까지 감시하고 생성 이벤트 전달
+                    emit_rescan_difference(wd, name, IN_CREATE | IN_ISDIR);
+                    watch_new_directory(wd, name);
+                }
+            }
+            else if (!known) {
+                emit_rescan_difference(wd, name, IN_CREATE);
+            }
+            else if (haveStat && (pathStat.st_mtim.tv_sec > rescanSince.tv_sec ||
+                     (pathStat.st_mtim.tv_sec == rescanSince.tv_sec && pathStat.st_mtim.tv_nsec >= rescanSince.tv_nsec))) {
+                emit_rescan_difference(wd, name, IN_MODIFY); // 유실 구간 이후 수정된 파일
+            }
+        }
+    }
+    close(fd);
+
+    // 기억하던 파일 중 사라진 것은 삭제 이벤트로 전달하고 집합을 현재 상태로 교체
+    EntrySet* known = &watchNodes[node].entries;
+    for (uint32_t i = 0; i < known->capacity; ++i) {
+        uint32_t nameId = known->slots[i];
+        if (nameId != NAME_NONE && !entry_set_contains(&seenFiles, nameId)) {
+            emit_rescan_difference(wd, name_string(nameId), IN_DELETE);
+        }
+    }
+    pthread_mutex_lock(&watchTableLock);
+    entry_set_free(known);
+    *known = seenFiles;
+    pthread_mutex_unlock(&watchTableLock);
+
+    // 사라진 하위 디렉토리는 감시 해제 후 삭제 이벤트로 전달, 남은 디렉토리는 재검사 큐에 추가
+    uint32_t child = watchNodes[node].firstChild;
+    while (child != WATCH_NODE_NONE) {
+        uint32_t next = watchNodes[child].nextSibling;
+        if (!entry_set_contains(&seenDirectories, watchNodes[child].name)) {
+            emit_rescan_difference(wd, name_string(watchNodes[child].name), IN_DELETE | IN_ISDIR);
+            prune_watch_subtree(child, monotonic_ms() + coalesceWindowMs);
+        }
+        else {
+            queue_rescan(child);
+        }
+        child = next;
+    }
+    entry_set_free(&seenDirectories);
+}
+
+// 재검사 큐에서 정해진 수만큼만 처리 (실시간 이벤트 처리가 밀리지 않도록)
+void continue_rescan(char* buffer, size_t bufferSize) {
+    for (int processed = 0; processed < RESCAN_BATCH_DIRS && rescanHead < rescanCount; ++processed) {
+        rescan_directory(rescanQueue[rescanHead++], buffer, bufferSize);
+    }
+
+    if (rescanHead == rescanCount && rescanCount > 0) {
+        char notice[256];
+        snprintf(notice, sizeof(notice), "rescan finished: %llu directories, %llu differences in %.2f s",
+                 (unsigned long long)rescanDirectories, (unsigned long long)rescanDifferences,
+                 (double)(monotonic_ms() - rescanStartMs) / 1000.0);
+        log_notice(IN_Q_OVERFLOW, notice);
+        rescanHead = rescanCount = 0;
+    }
+}
+
+// 짝이 없는 이동 이벤트 전달 (감시 트리 밖으로 나가거나 밖에서 들어온 경우)
+void emit_unpaired_move(int wd, const char* name, uint32_t mask, int64_t eventTimeNs, int64_t nowMs) {
+    track_directory_entry(wd, name, mask, (mask & IN_MOVED_TO) != 0);
+
+    int parent = find_watch_by_wd(wd);
+    if ((mask & IN_ISDIR) && parent >= 0) {
+        uint32_t nameId = find_name(name);
+        int node = nameId == NAME_NONE ? -1 : find_child_watch((uint32_t)parent, nameId);
+        if ((mask & IN_MOVED_FROM) && node >= 0) {
+            prune_watch_subtree((uint32_t)node, nowMs + coalesceWindowMs); // 밖으로 나간 트리는 감시 해제
+        }
+        else if (mask & IN_MOVED_TO) {
+            watch_new_directory(wd, name); // 밖에서 들어온 트리는 새 디렉토리처럼 감시 시작
+        }
+    }
+
+    if (has_filtered_extension(name)) return;
+
+    flush_pending_key(wd, name);
+    EventRecord record;
+    record.eventTimeNs = eventTimeNs;
+    record.mask = mask;
+    record.wd = wd;
+    record.count = 1;
+    record.oldPathOffset = 0;
+    if (build_event_path(wd, name, record.path, sizeof(record.path)) == -2) return; // 감시가 해제된 디렉토리
+    dispatch_event(&record);
+}
+
+// 짝을 기다리는 시간이 지난 IN_MOVED_FROM을 내보냄 (force이면 전부)
+void flush_pending_moves(int64_t nowMs, bool force) {
+    while (pendingMoveHead != pendingMoveTail) {
+        PendingMove* move = &pendingMoves[pendingMoveHead % MOVE_PAIR_MAX];
+        if (!force && move->deadlineMs > nowMs) break;
+        pendingMoveHead++;
+        if (move->cookie != 0) { // 0이면 이미 짝을 찾은 항목
+            emit_unpaired_move(move->wd, move->name, move->mask, move->eventTimeNs, nowMs);
+        }
+    }
+}
+
+// IN_MOVED_FROM을 짝이 올 때까지 보관
+void hold_moved_from(const struct inotify_event* watchEvent, int64_t eventTimeNs, int64_t nowMs) {
+    if (pendingMoveTail - pendingMoveHead == MOVE_PAIR_MAX) {
+        flush_pending_moves(pendingMoves[pendingMoveHead % MOVE_PAIR_MAX].deadlineMs, false); // 가득 차면 가장 오래된 항목을 짝 없는 이동으로 처리
+    }
+
+    PendingMove* move = &pendingMoves[pendingMoveTail % MOVE_PAIR_MAX];
+    move->cookie = watchEvent->cookie;
+    move->wd = watchEvent->wd;
+    move->mask = watchEvent->mask & (IN_MOVED_FROM | IN_ISDIR);
+    move->eventTimeNs = eventTimeNs;
+    move->deadlineMs = nowMs + MOVE_PAIR_WINDOW_MS;
+    strncpy(move->name, watchEvent->name, sizeof(move->name) - 1);
+    move->name[sizeof(move->name) - 1] = '\0';
+    pendingMoveTail++;
+}
+
+// IN_MOVED_TO를 쿠키로 짝지어 하나의 이름 변경 이벤트로 전달
+void pair_moved_to(const struct inotify_event* watchEvent, int64_t eventTimeNs, int64_t nowMs) {
+    PendingMove* move = NULL;
+    for (size_t i = pendingMoveTail; i != pendingMoveHead; --i) { // 짝은 보통 바로 앞에 있음
+        PendingMove* candidate = &pendingMoves[(i - 1) % MOVE_PAIR_MAX];
+        if (candidate->cookie == watchEvent->cookie && watchEvent->cookie != 0) {
+            move = candidate;
+            break;
+        }
+    }
+
+    uint32_t mask = watchEvent->mask & (IN_MOVED_TO | IN_ISDIR);
+    if (!move) {
+        emit_unpaired_move(watchEvent->wd, watchEvent->name, mask, eventTimeNs, nowMs);
+        return;
+    }
+    move->cookie = 0; // 짝을 찾았음을 표시
+    track_directory_entry(move->wd, move->name, mask, false);
+    track_directory_entry(watchEvent->wd, watchEvent->name, mask, true);
+
+    // 이전 이름과 새 이름에 쌓여 있던 이벤트를 먼저 내보내 순서 유지
+    flush_pending_key(move->wd, move->name);
+    flush_pending_key(watchEvent->wd, watchEvent->name);
+
+    EventRecord record;
+    record.eventTimeNs = move->eventTimeNs;
+    record.mask = IN_MOVED_FROM | mask;
+    record.wd = watchEvent->wd;
+    record.count = 1;
+    record.oldPathOffset = 0;
+
+    // 이전 경로는 노드를 다시 연결하기 전에 조립
+    char oldPath[PATH_MAX];
+    int oldLength = build_event_path(move->wd, move->name, oldPath, sizeof(oldPath));
+
+    if (mask & IN_ISDIR) {
+        int fromParent = find_watch_by_wd(move->wd);
+        int toParent = find_watch_by_wd(watchEvent->wd);
+        uint32_t oldName = find_name(move->name);
+        int node = fromParent < 0 || oldName == NAME_NONE ? -1 : find_child_watch((uint32_t)fromParent, oldName);
+
+        if (node >= 0 && toParent >= 0) {
+            uint32_t newName = find_name(watchEvent->name);
+            int replaced = newName == NAME_NONE ? -1 : find_child_watch((uint32_t)toParent, newName);
+            if (replaced >= 0 && replaced != node) {
+                retire_watch_node((uint32_t)replaced, nowMs + coalesceWindowMs); // 덮어쓴 빈 디렉토리
+            }
+            if (rename_watch_node((uint32_t)node, (uint32_t)toParent, watchEvent->name) == -1) {
+                fprintf(stderr, "Error renaming watch node %s\n", watchEvent->name);
+            }
+        }
+        else if (toParent >= 0) {
+            watch_new_directory(watchEvent->wd, watchEvent->name); // 감시하지 않던 디렉토리
+        }
+    }
+
+    if (has_filtered_extension(watchEvent->name) && has_filtered_extension(move->name)) return;
+
+    int length = build_event_path(watchEvent->wd, watchEvent->name, record.path, sizeof(record.path));
+    if (length == -2) return; // 감시가 해제된 디렉토리로 옮겨짐 (이전 경로를 모르면 이전 경로 없이 보냄)
+    if (length >= 0 && oldLength >= 0 && (size_t)length + 1 + (size_t)oldLength < sizeof(record.path)) {
+        record.oldPathOffset = (uint32_t)length + 1;
+        memcpy(record.path + record.oldPathOffset, oldPath, (size_t)oldLength + 1);
+    }
+    dispatch_event(&record);
+}
+
+// 이벤트 처리 함수
+void process_event(const struct inotify_event* watchEvent) {
+    int64_t nowMs = batchClock.monotonicNs / 1000000; // 묶음을 읽을 때 잰 시각을 공유 (이벤트마다 시계를 읽지 않음)
+    int64_t eventTimeNs = batchClock.realtimeNs;
+
+    if (watchEvent->mask & IN_Q_OVERFLOW) {
+        handle_queue_overflow(); // 커널 큐가 넘쳐 이벤트가 유실됨
+        return;
+    }
+
+    if (watchEvent->mask & IN_IGNORED) {
+        // 디렉토리가 삭제되었거나 감시가 해제됨: 병합 창이 끝난 뒤 노드 해제
+        int node = find_watch_by_wd(watchEvent->wd);
+        if (node >= 0) {
+            retire_watch_node((uint32_t)node, nowMs + coalesceWindowMs);
+        }
+        return;
+    }
+
+    if (watchEvent->len > 0) {
+        note_recent_activity(watchEvent->wd);
+        if (watchEvent->mask & (IN_CREATE | IN_DELETE)) {
+            track_directory_entry(watchEvent->wd, watchEvent->name, watchEvent->mask, (watchEvent->mask & IN_CREATE) != 0);
+        }
+    }
+
+    if (watchEvent->len > 0 && (watchEvent->mask & IN_MOVED_FROM)) {
+        hold_moved_from(watchEvent, eventTimeNs, nowMs); // 짝이 되는 IN_MOVED_TO를 기다림
+        return;
+    }
+    if (watchEvent->len > 0 && (watchEvent->mask & IN_MOVED_TO)) {
+        pair_moved_to(watchEvent, eventTimeNs, nowMs);
+        return;
+    }
+
+    if (watchEvent->len > 0) {
+        const char* filename = watchEvent->name;
+
+        // 새 디렉토리는 필터와 상관없이 하위 트리까지 감시 시작
+        if ((watchEvent->mask & IN_CREATE) && (watchEvent->mask & IN_ISDIR)) {
+            watch_new_directory(watchEvent->wd, filename);
+        }
+
+        // 필터링된 확장자일 경우 처리하지 않음
+        if (has_filtered_extension(filename)) {
+            return; // 필터링된 파일은 이벤트를 처리하지 않음
+        }
+
+        // 같은 파일의 연속된 이벤트는 병합 창이 끝날 때 하나로 기록
+        coalesce_event(watchEvent->wd, filename, watchEvent->mask, eventTimeNs, nowMs);
+        flush_coalesced_events(nowMs, false);
+    }
+}
+
+// 읽어 온 버퍼에 들어 있는 모든 inotify 레코드를 한꺼번에 처리
+void process_event_batch(const char* buffer, size_t length) {
+    const char* buffPointer = buffer;
+    const char* bufferEnd = buffer + length;
+
+    while (buffPointer + sizeof(struct inotify_event) <= bufferEnd) {
+        const struct inotify_event* watchEvent = (const struct inotify_event*)buffPointer;
+        size_t recordSize = sizeof(struct inotify_event) + watchEvent->len;
+
+        if (buffPointer + recordSize > bufferEnd) {
+            fprintf(stderr, "Truncated inotify record (%zu bytes left)\n", (size_t)(bufferEnd - buffPointer));
+            break; // 커널은 레코드를 잘라서 주지 않으므로 정상적으로는 발생하지 않음
+        }
+
+        process_event(watchEvent);
+        buffPointer += recordSize; // 다음 레코드로 이동
+    }
+}
+
+// 논블로킹 inotify 큐를 비울 때까지 읽기 (오류 시 -1 반환)
+int drain_inotify_queue(char* buffer, size_t bufferSize) {
+    for (int reads = 0; reads < INOTIFY_MAX_READS_PER_WAKEUP; ++reads) {
+        ssize_t readLength = read(IeventQueue, buffer, bufferSize);
+        if (readLength > 0) {
+            sample_event_clock();
+            process_event_batch(buffer, (size_t)readLength);
+            continue;
+        }
+
+        if (readLength == -1 && errno == EINTR) {
+            continue; // 시그널로 중단된 경우 다시 시도
+        }
+        if (readLength == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            clock_gettime(CLOCK_REALTIME, &lastQueueDrainedTime); // 여기까지의 이벤트는 모두 받았음
+            return 0; // 큐가 비었음
+        }
+
+        perror("Error reading from inotify instance");
+        return -1;
+    }
+    return 0; // 남은 이벤트는 다음 epoll_wait에서 이어서 처리 (level-triggered)
+}
+
+// 파일 핸들 해시 (FNV-1a)
+uint32_t hash_file_handle(const __kernel_fsid_t* fsid, const struct file_handle* handle) {
+    uint32_t hash = 2166136261u;
+    const unsigned char* parts[2] = { (const unsigned char*)fsid, handle->f_handle };
+    size_t lengths[2] = { sizeof(*fsid), handle->handle_bytes };
+    for (int part = 0; part < 2; ++part) {
+        for (size_t i = 0; i < lengths[part]; ++i) {
+            hash ^= parts[part][i];
+            hash *= 16777619u;
+        }
+    }
+    return mix32(hash ^ (uint32_t)handle->handle_type);
+}
+
+// 캐시 항목이 같은 디렉토리 핸들인지 확인
+bool handle_cache_matches(const HandleCacheEntry* entry, const __kernel_fsid_t* fsid, const struct file_handle* handle) {
+    return entry->used && entry->handleType == handle->handle_type && entry->handleBytes == handle->handle_bytes &&
+           memcmp(&entry->fsid, fsid, sizeof(*fsid)) == 0 && memcmp(entry->handle, handle->f_handle, handle->handle_bytes) == 0;
+}
+
+// 경로가 속한 감시 루트 찾기 (없으면 NULL)
+FanotifyRoot* find_fanotify_root(const char* path) {
+    for (int i = 0; i < fanotifyRootCount; ++i) {
+        FanotifyRoot* root = &fanotifyRoots[i];
+        if (strncmp(path, root->realPath, root->length) == 0 &&
+            (path[root->length] == '/' || path[root->length] == '\0')) {
+            return root;
+        }
+    }
+    return NULL;
+}
+
+// 감시 루트 아래 경로의 디렉토리 노드를 찾고, 아직 없는 구성 요소는 노드로 추가 (wd 반환, 실패 시 -1)
+int fanotify_directory_wd(const char* path) {
+    FanotifyRoot* root = find_fanotify_root(path);
+    if (!root) return -1;
+
+    uint32_t node = root->node;
+    const char* component = path + root->length;
+    while (*component) {
+        while (*component == '/') component++;
+        if (!*component) break;
+
+        char componentName[NAME_MAX + 1];
+        size_t length = strcspn(component, "/");
+        if (length > NAME_MAX) return -1;
+        memcpy(componentName, component, length);
+        componentName[length] = '\0';
+        component += length;
+
+        uint32_t name = find_name(componentName);
+        int child = name == NAME_NONE ? -1 : find_child_watch(node, name);
+        if (child < 0) {
+            child = add_watch_node(fanotifyNextWd++, node, componentName);
+            if (child < 0) return -1;
+        }
+        node = (uint32_t)child;
+    }
+    return watchNodes[node].wd;
+}
+
+// 디렉토리 파일 핸들을 경로로 변환 (삭제되었거나 열 수 없으면 -1)
+int resolve_directory_handle(const __kernel_fsid_t* fsid, struct file_handle* handle, char* path, size_t pathSize) {
+    int mountFd = -1;
+    for (int i = 0; i < fanotifyRootCount && mountFd == -1; ++i) {
+        if (memcmp(&fanotifyRoots[i].fsid, fsid, sizeof(*fsid)) == 0) mountFd = fanotifyRoots[i].mountFd;
+    }
+    if (mountFd == -1) return -1;
+
+    int fd = open_by_handle_at(mountFd, handle, O_PATH | O_CLOEXEC);
+    if (fd == -1) return -1; // ESTALE: 이미 삭제된 디렉토리
+
+    char fdPath[64];
+    snprintf(fdPath, sizeof(fdPath), "/proc/self/fd/%d", fd);
+    ssize_t length = readlink(fdPath, path, pathSize - 1);
+    close(fd);
+    if (length <= 0 || (size_t)length >= pathSize - 1) return -1;
+    path[length] = '\0';
+
+    static const char deletedSuffix[] = " (deleted)";
+    size_t suffixLength = sizeof(deletedSuffix) - 1;
+    if ((size_t)length > suffixLength && strcmp(path + length - suffixLength, deletedSuffix) == 0) return -1;
+    return 0;
+}
+
+// 이벤트 정보의 디렉토리 핸들을 노드 wd로 변환 (캐시 우선, 감시 루트 밖이면 -1)
+int fanotify_lookup_directory(const struct fanotify_event_info_fid* info) {
+    struct file_handle* handle = (struct file_handle*)info->handle;
+    HandleCacheEntry* entry = &handleCache[hash_file_handle(&info->fsid, handle) & (FANOTIFY_HANDLE_CACHE_SIZE - 1)];
+
+    if (handle_cache_matches(entry, &info->fsid, handle)) {
+        if (entry->wd == -1 && entry->generation == fanotifyMoveGeneration) return -1;
+        if (entry->wd != -1) {
+            int node = find_watch_by_wd(entry->wd);
+            if (node >= 0 && !(watchNodes[node].flags & WATCH_NODE_DEAD)) return entry->wd;
+        }
+    }
+
+    char path[PATH_MAX];
+    if (resolve_directory_handle(&info->fsid, handle, path, sizeof(path)) == -1) return -1;
+    int wd = fanotify_directory_wd(path);
+
+    if (handle->handle_bytes <= FANOTIFY_HANDLE_MAX) {
+        entry->used = true;
+        entry->fsid = info->fsid;
+        entry->handleType = handle->handle_type;
+        entry->handleBytes = handle->handle_bytes;
+        memcpy(entry->handle, handle->f_handle, handle->handle_bytes);
+        entry->wd = wd;
+        entry->generation = fanotifyMoveGeneration;
+    }
+    return wd;
+}
+
+// 변환한 이벤트를 inotify 레코드로 만들어 같은 처리 경로로 전달
+void deliver_fanotify_event(int wd, const char* name, uint32_t mask, uint32_t cookie) {
+    union {
+        struct inotify_event event;
+        char bytes[sizeof(struct inotify_event) + NAME_MAX + 1];
+    } record;
+
+    size_t length = strlen(name) + 1;
+    if (length > NAME_MAX + 1) return;
+    record.event.wd = wd;
+    record.event.mask = mask;
+    record.event.cookie = cookie;
+    record.event.len = (uint32_t)length;
+    memcpy(record.event.name, name, length);
+    process_event(&record.event);
+}
+
+// 이벤트 정보 레코드의 디렉토리 wd와 이름 얻기 (감시 루트 밖이거나 이름이 없으면 false)
+bool fanotify_event_target(const struct fanotify_event_info_fid* info, int* wd, const char** name) {
+    if (!info) return false;
+    const struct file_handle* handle = (const struct file_handle*)info->handle;
+    *name = (const char*)handle->f_handle + handle->handle_bytes;
+    if ((*name)[0] == '\0' || strcmp(*name, ".") == 0) return false; // 디렉토리 자신에 대한 이벤트
+    *wd = fanotify_lookup_directory(info);
+    return *wd != -1;
+}
+
+// fanotify 이벤트 하나를 inotify 형식으로 변환하여 처리
+void process_fanotify_event(const struct fanotify_event_metadata* metadata) {
+    if (metadata->fd >= 0) close(metadata->fd); // FID 보고 모드에서는 열린 fd가 오지 않음
+
+    if (metadata->mask & FAN_Q_OVERFLOW) {
+        deliver_fanotify_event(-1, "", IN_Q_OVERFLOW, 0);
+        fanotifyMovedFromCookie = 0;
+        return;
+    }
+
+    const struct fanotify_event_info_fid* target = NULL;  // 이벤트가 발생한 디렉토리와 이름
+    const struct fanotify_event_info_fid* oldTarget = NULL; // FAN_RENAME의 이전 위치
+    const struct fanotify_event_info_fid* newTarget = NULL; // FAN_RENAME의 새 위치
+    for (uint32_t offset = metadata->metadata_len; offset + sizeof(struct fanotify_event_info_header) <= metadata->event_len;) {
+        const struct fanotify_event_info_header* header = (const struct fanotify_event_info_header*)((const char*)metadata + offset);
+        if (header->len == 0 || offset + header->len > metadata->event_len) break;
+
+        const struct fanotify_event_info_fid* info = (const struct fanotify_event_info_fid*)header;
+        if (header->info_type == FAN_EVENT_INFO_TYPE_DFID_NAME) target = info;
+        else if (header->info_type == FAN_EVENT_INFO_TYPE_OLD_DFID_NAME) oldTarget = info;
+        else if (header->info_type == FAN_EVENT_INFO_TYPE_NEW_DFID_NAME) newTarget = info;
+        offset += header->len;
+    }
+
+    uint32_t dirBit = (metadata->mask & FAN_ONDIR) ? IN_ISDIR : 0;
+    int wd;
+    const char* name;
+
+    if (metadata->mask & FAN_RENAME) {
+        uint32_t cookie = ++fanotifyNextCookie ? fanotifyNextCookie : ++fanotifyNextCookie;
+        if (dirBit) fanotifyMoveGeneration++; // 루트 밖이던 디렉토리가 안으로 들어왔을 수 있음
+        if (fanotify_event_target(oldTarget, &wd, &name)) deliver_fanotify_event(wd, name, IN_MOVED_FROM | dirBit, cookie);
+        if (fanotify_event_target(newTarget, &wd, &name)) deliver_fanotify_event(wd, name, IN_MOVED_TO | dirBit, cookie);
+        return;
+    }
+
+    // FAN_RENAME이 없는 커널: 큐에서 바로 이어지는 FAN_MOVED_FROM/FAN_MOVED_TO를 한 쌍으로 간주
+    uint32_t cookie = 0;
+    if (metadata->mask & FAN_MOVED_TO) {
+        cookie = fanotifyMovedFromCookie;
+        if (dirBit) fanotifyMoveGeneration++;
+    }
+    fanotifyMovedFromCookie = 0;
+    if (metadata->mask & FAN_MOVED_FROM) {
+        cookie = ++fanotifyNextCookie ? fanotifyNextCookie : ++fanotifyNextCookie;
+        fanotifyMovedFromCookie = cookie;
+    }
+
+    if (!fanotify_event_target(target, &wd, &name)) return;
+
+    uint32_t mask = dirBit;
+    if (metadata->mask & FAN_CREATE) mask |= IN_CREATE;
+    if (metadata->mask & FAN_DELETE) mask |= IN_DELETE;
+    if (metadata->mask & FAN_MODIFY) mask |= IN_MODIFY;
+    if (metadata->mask & FAN_MOVED_FROM) mask |= IN_MOVED_FROM;
+    if (metadata->mask & FAN_MOVED_TO) mask |= IN_MOVED_TO;
+    if ((mask & ~IN_ISDIR) == 0) return;
+
+    deliver_fanotify_event(wd, name, mask, cookie);
+
+    // 삭제된 디렉토리 노드는 inotify의 IN_IGNORED처럼 해제
+    if ((mask & IN_DELETE) && dirBit) {
+        int parent = find_watch_by_wd(wd);
+        uint32_t nameId = find_name(name);
+        int node = parent < 0 || nameId == NAME_NONE ? -1 : find_child_watch((uint32_t)parent, nameId);
+        if (node >= 0) deliver_fanotify_event(watchNodes[node].wd, "", IN_IGNORED, 0);
+    }
+}
+
+// 논블로킹 fanotify 큐를 비울 때까지 읽기 (오류 시 -1 반환)
+int drain_fanotify_queue(char* buffer, size_t bufferSize) {
+    for (int reads = 0; reads < INOTIFY_MAX_READS_PER_WAKEUP; ++reads) {
+        ssize_t readLength = read(FanotifyFd, buffer, bufferSize);
+        if (readLength > 0) {
+            sample_event_clock();
+            const struct fanotify_event_metadata* metadata = (const struct fanotify_event_metadata*)buffer;
+            size_t remaining = (size_t)readLength;
+            for (; FAN_EVENT_OK(metadata, remaining); metadata = FAN_EVENT_NEXT(metadata, remaining)) {
+                if (metadata->vers != FANOTIFY_METADATA_VERSION) {
+                    fprintf(stderr, "Unsupported fanotify metadata version %u\n", metadata->vers);
+                    return -1;
+                }
+                process_fanotify_event(metadata);
+            }
+            continue;
+        }
+
+        if (readLength == -1 && errno == EINTR) {
+            continue;
+        }
+        if (readLength == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            clock_gettime(CLOCK_REALTIME, &lastQueueDrainedTime);
+            return 0;
+        }
+
+        perror("Error reading from fanotify instance");
+        return -1;
+    }
+    return 0;
+}
+
+// 감시 루트가 속한 파일 시스템에 fanotify 표시 (같은 파일 시스템은 한 번만 표시)
+int mark_fanotify_filesystem(FanotifyRoot* root, bool alreadyMarked) {
+    if (alreadyMarked) return 0;
+
+    uint64_t mask = FANOTIFY_WATCH_MASK;
+    if (!fanotifyRenameEvents) mask = (mask & ~(uint64_t)FAN_RENAME) | FANOTIFY_LEGACY_MOVE_MASK;
+    if (fanotify_mark(FanotifyFd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, mask, AT_FDCWD, root->realPath) == 0) {
+        return 0;
+    }
+    if (errno == EINVAL && fanotifyRenameEvents) { // FAN_RENAME을 모르는 커널
+        fanotifyRenameEvents = false;
+        return mark_fanotify_filesystem(root, false);
+    }
+    fprintf(stderr, "Error marking filesystem of %s: %s\n", root->realPath, strerror(errno));
+    return -1;
+}
+
+// fanotify 상태 해제 (초기화에 실패하면 inotify로 돌아가기 전에 호출)
+void release_fanotify() {
+    if (FanotifyFd != -1) close(FanotifyFd);
+    FanotifyFd = -1;
+    for (int i = 0; i < fanotifyRootCount; ++i) {
+        close(fanotifyRoots[i].mountFd);
+        free(fanotifyRoots[i].realPath);
+    }
+    free(fanotifyRoots);
+    free(handleCache);
+    fanotifyRoots = NULL;
+    handleCache = NULL;
+    fanotifyRootCount = 0;
+    fanotifyNextWd = 1;
+}
+
+// fanotify 백엔드 초기화: 루트가 속한 파일 시스템마다 표시 하나로 전체를 감시 (실패 시 -1)
+int init_fanotify(char monitoredDirs[][512], int dirCount) {
+    FanotifyFd = fanotify_init(FAN_CLASS_NOTIF | FAN_REPORT_DFID_NAME | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_CLOEXEC | O_LARGEFILE);
+    if (FanotifyFd == -1) {
+        perror("Error initializing fanotify instance");
+        return -1;
+    }
+
+    fanotifyRoots = calloc((size_t)dirCount, sizeof(FanotifyRoot));
+    handleCache = calloc(FANOTIFY_HANDLE_CACHE_SIZE, sizeof(HandleCacheEntry));
+    if ((!fanotifyRoots && dirCount > 0) || !handleCache) {
+        fprintf(stderr, "Error allocating fanotify state\n");
+        release_fanotify();
+        return -1;
+    }
+
+    // 모든 표시가 끝난 뒤에 노드를 만들어, 실패해서 inotify로 돌아가도 감시 테이블이 비어 있게 함
+    for (int i = 0; i < dirCount; ++i) {
+        FanotifyRoot* root = &fanotifyRoots[fanotifyRootCount];
+        root->realPath = realpath(monitoredDirs[i], NULL);
+        root->mountFd = root->realPath ? open(root->realPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+        struct statfs fsStat;
+        if (root->mountFd == -1 || fstatfs(root->mountFd, &fsStat) == -1) {
+            fprintf(stderr, "Error opening directory %s: %s\n", monitoredDirs[i], strerror(errno));
+            if (root->mountFd != -1) close(root->mountFd);
+            free(root->realPath);
+            continue;
+        }
+        root->length = strlen(root->realPath);
+        if (root->length == 1) root->length = 0; // "/"이면 모든 경로가 "/"로 시작
+        memcpy(&root->fsid, &fsStat.f_fsid, sizeof(root->fsid));
+
+        bool alreadyMarked = false;
+        for (int j = 0; j < fanotifyRootCount; ++j) {
+            if (memcmp(&fanotifyRoots[j].fsid, &root->fsid, sizeof(root->fsid)) == 0) alreadyMarked = true;
+        }
+        if (mark_fanotify_filesystem(root, alreadyMarked) == -1) {
+            close(root->mountFd);
+            free(root->realPath);
+            continue;
+        }
+        root->node = i; // 아래에서 노드 번호로 바꿈 (설정 순서 보관)
+        fanotifyRootCount++;
+    }
+
+    if (fanotifyRootCount == 0) {
+        release_fanotify();
+        return -1;
+    }
+
+    for (int i = 0; i < fanotifyRootCount; ++i) {
+        int node = add_watch_node(fanotifyNextWd++, WATCH_NODE_NONE, monitoredDirs[fanotifyRoots[i].node]);
+        if (node < 0) {
+            fprintf(stderr, "Error storing watch for %s\n", fanotifyRoots[i].realPath);
+            release_fanotify(); // 이미 만든 루트 노드는 호출자가 감시 테이블을 다시 초기화하여 지움
+            return -1;
+        }
+        fanotifyRoots[i].node = (uint32_t)node;
+    }
+    printf("fanotify: %d roots, %s\n", fanotifyRootCount,
+           fanotifyRenameEvents ? "rename events" : "move events without rename pairing");
+    return 0;
+}
+
+// 헤드리스 모드에서 이벤트 루프를 멈추는 시그널
+void stop_signal_set(sigset_t* signals) {
+    sigemptyset(signals);
+    sigaddset(signals, SIGINT);
+    sigaddset(signals, SIGTERM);
+    sigaddset(signals, SIGHUP);
+}
+
+// 종료 시그널을 모든 스레드에서 막음 (다른 스레드를 만들기 전에 호출해야 상속됨)
+void block_stop_signals() {
+    sigset_t signals;
+    stop_signal_set(&signals);
+    pthread_sigmask(SIG_BLOCK, &signals, NULL);
+}
+
+// 이벤트 루프 초기화 (epoll + 깨우기용 eventfd, 헤드리스 모드면 signalfd)
+int init_event_loop() {
+    EpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (EpollFd == -1) {
+        perror("Error creating epoll instance");
+        return -1;
+    }
+
+    WakeupFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (WakeupFd == -1) {
+        perror("Error creating wakeup eventfd");
+        return -1;
+    }
+
+    int sourceFd = useFanotify ? FanotifyFd : IeventQueue; // 사용하는 감시 백엔드
+    struct epoll_event ev = { .events = EPOLLIN };
+    ev.data.fd = sourceFd;
+    if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, sourceFd, &ev) == -1) {
+        perror("Error adding watch instance to epoll");
+        return -1;
+    }
+
+    ev.data.fd = WakeupFd;
+    if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, WakeupFd, &ev) == -1) {
+        perror("Error adding wakeup eventfd to epoll");
+        return -1;
+    }
+
+    if (headless) { // 종료 시그널을 이벤트 루프에서 받음 (block_stop_signals로 미리 막아 둠)
+        sigset_t signals;
+        stop_signal_set(&signals);
+        SignalFd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (SignalFd == -1) {
+            perror("Error creating signalfd");
+            return -1;
+        }
+        ev.data.fd = SignalFd;
+        if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, SignalFd, &ev) == -1) {
+            perror("Error adding signalfd to epoll");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 이벤트 루프 깨우기 (다른 스레드에서 호출 가능)
+void wakeup_event_loop() {
+    uint64_t one = 1;
+    if (write(WakeupFd, &one, sizeof(one)) == -1 && errno != EAGAIN) {
+        perror("Error writing wakeup eventfd");
+    }
+}
+
+// 이벤트 루프 종료 요청
+void stop_event_loop() {
+    monitorRunning = 0;
+    wakeup_event_loop();
+}
+
+// 감시 스레드 오류 시 GTK 메인 루프 종료
+gboolean quit_main_loop(gpointer data) {
+    gtk_main_quit();
+    return FALSE;
+}
+
+void* inotify_thread(void* arg) {
+    char* buffer = NULL; // 이벤트를 받을 버퍼 (스레드 수명 동안 재사용)
+    if (posix_memalign((void**)&buffer, INOTIFY_READ_BUFFER_ALIGN, INOTIFY_READ_BUFFER_SIZE) != 0) {
+        fprintf(stderr, "Error allocating inotify read buffer\n");
+        watcherExitCode = EXT_ERR_READ_INOTIFY;
+        if (!headless) g_idle_add(quit_main_loop, NULL);
+        return NULL;
+    }
+
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+    while (monitorRunning) {
+        // 병합 대기 중인 이벤트가 있으면 가장 빠른 마감 시각까지만 대기
+        int readyCount = epoll_wait(EpollFd, events, EPOLL_MAX_EVENTS, next_event_loop_timeout(monotonic_ms()));
+        if (readyCount == -1) {
+            if (errno == EINTR) continue;
+            perror("Error waiting on epoll instance");
+            watcherExitCode = EXT_ERR_READ_INOTIFY;
+            break;
+        }
+
+        for (int i = 0; i < readyCount; ++i) {
+            if (events[i].data.fd == WakeupFd) {
+                uint64_t count;
+                while (read(WakeupFd, &count, sizeof(count)) > 0) {
+                    // 깨우기 카운터 비우기
+                }
+            }
+            else if (events[i].data.fd == IeventQueue) {
+                if (drain_inotify_queue(buffer, INOTIFY_READ_BUFFER_SIZE) == -1) {
+                    watcherExitCode = EXT_ERR_READ_INOTIFY;
+                    monitorRunning = 0;
+                }
+            }
+            else if (events[i].data.fd == SignalFd) {
+                struct signalfd_siginfo signalInfo;
+                while (read(SignalFd, &signalInfo, sizeof(signalInfo)) == sizeof(signalInfo)) {
+                    printf("Received signal %u, stopping\n", signalInfo.ssi_signo);
+                    monitorRunning = 0; // 남은 이벤트를 기록하고 정상 종료
+                }
+            }
+            else if (events[i].data.fd == FanotifyFd) {
+                if (drain_fanotify_queue(buffer, INOTIFY_READ_BUFFER_SIZE) == -1) {
+                    watcherExitCode = EXT_ERR_READ_INOTIFY;
+                    monitorRunning = 0;
+                }
+            }
+            else {
+                handle_subscriber_event(&events[i]); // 구독 소켓 연결/요청/전송 가능
+            }
+        }
+
+        int64_t nowMs = monotonic_ms();
+        continue_rescan(buffer, INOTIFY_READ_BUFFER_SIZE); // 오버플로 재검사를 조금씩 진행
+        continue_root_crawl();                // 초기 탐색을 시간 조각 하나만큼 진행
+        flush_pending_moves(nowMs, false);    // 짝이 오지 않은 이동 이벤트 내보내기
+        flush_coalesced_events(nowMs, false); // 마감된 병합 이벤트 내보내기
+        release_retired_watches(nowMs);       // 삭제된 디렉토리 노드 해제
+        flush_subscribers();                  // 이번 반복에서 쌓인 프레임 전송
+    }
+
+    flush_pending_moves(0, true);    // 종료 전 남은 이벤트 모두 기록
+    flush_coalesced_events(0, true);
+    flush_subscribers();
+    close_subscription_server();
+    if (rootCrawl) finish_root_crawl(); // 탐색 중에 종료하면 탐색 스레드 중단
+    free(buffer);
+
+    if (watcherExitCode != EXT_SUCCESS && !headless) {
+        g_idle_add(quit_main_loop, NULL); // 오류로 종료된 경우 UI도 종료
+    }
+    return NULL;
 }
 
 int main(int argc, char** argv) {
-    if (argc < 2) { // 인자가 부족한 경우
-        fprintf(stderr, "USAGE: file_monitor CONFIG_PATH\n");
+    bool headlessFlag = argc >= 2 && strcmp(argv[1], "--headless") == 0;
+    if (argc < 2 + headlessFlag) { // 인자가 부족한 경우
+        fprintf(stderr, "USAGE: file_monitor [--headless] CONFIG_PATH\n");
         exit(EXT_ERR_TOO_FEW_ARGS); // 종료
     }
+    const char* configPath = argv[1 + headlessFlag];
 
     char monitoredDirs[512][512];  // 모니터링할 디렉토리 배열
     int dirCount = 0; // 모니터링할 디렉토리 개수
 
-    read_config(argv[1], monitoredDirs, &dirCount); // 설정 파일 읽기
+    read_config(configPath, monitoredDirs, &dirCount); // 설정 파일 읽기
+    if (headlessFlag) headless = true; // 명령행 인자가 설정보다 우선
+
+    if (headless) {
+        block_stop_signals(); // 감시 루프가 signalfd로 받음
+        if (!subscribeSocketPath[0] && !eventRingName[0]) {
+            printf("Headless mode: events are written to the log file only (set subscribe_socket or event_ring_name to attach clients)\n");
+        }
+    }
     init_log_file(logFilePath); // 로그 파일 초기화
-    init_log_ui();
-    init_css();
+    if (!headless) init_log_ui(); // 헤드리스 모드에서는 디스플레이에 연결하지 않음
 
     check_filtered_extension();  // 필터링 확장자 확인 (한 번만 출력)
 
-    IeventQueue = inotify_init();  // inotify 인스턴스 초기화
-    if (IeventQueue == -1) {
-        fprintf(stderr, "Error initializing inotify instance\n");
-        exit(EXT_ERR_INIT_INOTIFY); // 초기화 실패 시 종료
+    if (init_watch_table() == -1) {
+        fprintf(stderr, "Error allocating watch table\n");
+        exit(EXT_ERR_ADD_WATCH);
     }
 
-    for (int i = 0; i < dirCount; ++i) {
-        add_watch_recursive(monitoredDirs[i]); // 디렉토리 감시 추가
+    if (useFanotify && init_fanotify(monitoredDirs, dirCount) == -1) {
+        fprintf(stderr, "Falling back to inotify backend\n"); // 권한(CAP_SYS_ADMIN)이나 커널 지원이 없는 경우
+        useFanotify = false;
+        if (reset_watch_table() == -1) { // 일부 루트 노드가 남아 있을 수 있음
+            fprintf(stderr, "Error allocating watch table\n");
+            exit(EXT_ERR_ADD_WATCH);
+        }
     }
 
-    pthread_t thread;
-    pthread_create(&thread, NULL, inotify_thread, NULL);
+    if (useFanotify) {
+        overflowRescan = false; // 탐색을 하지 않으므로 비교할 디렉토리 항목이 없음
+    }
+    else {
+        IeventQueue = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);  // inotify 인스턴스 초기화 (논블로킹)
+        if (IeventQueue == -1) {
+            fprintf(stderr, "Error initializing inotify instance\n");
+            exit(EXT_ERR_INIT_INOTIFY); // 초기화 실패 시 종료
+        }
+
+        start_root_crawl(monitoredDirs, dirCount); // 루트 감시 추가 (하위 트리는 감시 루프가 병렬로 탐색)
+        if (!headless) g_timeout_add(CRAWL_PROGRESS_INTERVAL_MS, update_crawl_progress, NULL);
+    }
+
+    // 목록에는 루트만 바로 추가 (하위 디렉토리는 탐색되는 대로 펼칠 수 있게 됨)
+    for (uint32_t node = 0; node < watchNodeCount && !headless; ++node) {
+        if (watchNodes[node].parent == WATCH_NODE_NONE) add_directory_to_list((int)node);
+    }
+
+    if (!headless && spsc_ring_init(&uiRing, UI_RING_CAPACITY, sizeof(EventRecord)) == -1) {
+        fprintf(stderr, "Error allocating UI event ring\n");
+        exit(EXT_ERR_EVENT_LOOP);
+    }
+
+    if (start_log_writer() == -1) {
+        fprintf(stderr, "Error starting log writer\n");
+        exit(EXT_ERR_EVENT_LOOP);
+    }
+
+    runEpochNs = realtime_ns();
+    if (init_change_index() == -1) {
+        fprintf(stderr, "Error allocating change index\n");
+        exit(EXT_ERR_EVENT_LOOP);
+    }
+
+    if (init_coalescer() == -1) {
+        fprintf(stderr, "Error allocating event coalescer\n");
+        exit(EXT_ERR_EVENT_LOOP);
+    }
+
+    clock_gettime(CLOCK_REALTIME, &lastQueueDrainedTime);
+    if (init_event_loop() == -1) {
+        exit(EXT_ERR_EVENT_LOOP); // 이벤트 루프 초기화 실패 시 종료
+    }
+
+    if (eventRingName[0] && init_event_ring(eventRingName) == -1) {
+        exit(EXT_ERR_EVENT_LOOP); // 설정한 이벤트 링을 만들 수 없으면 종료
+    }
+
+    if (subscribeSocketPath[0] && init_subscription_server(subscribeSocketPath) == -1) {
+        exit(EXT_ERR_EVENT_LOOP); // 설정한 구독 소켓을 열 수 없으면 종료
+    }
+
+    if (headless) {
+        inotify_thread(NULL); // 메인 스레드가 감시 루프를 돌고, 종료 시그널을 받으면 돌아옴
+    }
+    else {
+        start_sound_worker(); // 사운드 서버 연결은 사운드 스레드가 한 번만 염
+        pthread_t thread;
+        pthread_create(&thread, NULL, inotify_thread, NULL);
 
-    gtk_main();
+        gtk_main();
+
+        stop_event_loop(); // 창이 닫히면 감시 스레드 종료
+        pthread_join(thread, NULL);
+        stop_sound_worker();
+    }
+    stop_log_writer(); // 남은 로그를 기록하고 파일 닫기
+    close_event_ring();
+    free_change_index();
+
+    close(WakeupFd);
+    if (SignalFd != -1) close(SignalFd);
+    close(EpollFd);
+    if (IeventQueue != -1) close(IeventQueue);
+    if (FanotifyFd != -1) close(FanotifyFd);
+    for (int i = 0; i < fanotifyRootCount; ++i) {
+        close(fanotifyRoots[i].mountFd);
+        free(fanotifyRoots[i].realPath);
+    }
+    free(fanotifyRoots);
+    free(handleCache);
+    free(uiRing.slots);
+    free(pendingPool);
 
-    return EXT_SUCCESS; // 정상 종료
+    return watcherExitCode; // 감시 스레드 종료 코드 반환
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+// file_monitor 바이너리 저널 형식 (file_monitor가 기록하고 journal_query가 mmap으로 읽음)
+//
+// 저널은 세 파일로 이루어지며, 모두 JournalHeader로 시작하고 뒤에만 추가됨
+//   <journal_file>          고정 크기 JournalRecord 배열 (레코드 번호 = 순서 번호)
+//   <journal_file>.strings  경로 문자열 표 (JournalString 항목, 같은 경로는 한 번만 저장)
+//   <journal_file>.index    JOURNAL_BLOCK_RECORDS개 레코드마다 하나씩 JournalIndexBlock
+#ifndef FILE_MONITOR_JOURNAL_H
+#define FILE_MONITOR_JOURNAL_H
+
+#include <stdint.h>
+
+#define JOURNAL_RECORD_MAGIC 0x4e524a46u      // "FJRN"
+#define JOURNAL_STRING_MAGIC 0x52544a46u      // "FJTR"
+#define JOURNAL_INDEX_MAGIC 0x58494a46u       // "FJIX"
+#define JOURNAL_VERSION 2                     // 2: 블룸 필터를 레코드당 16비트로 키움
+#define JOURNAL_BLOCK_RECORDS 4096            // 색인 블록 하나가 다루는 레코드 수
+#define JOURNAL_BLOOM_BITS 65536              // 색인 블록의 경로 블룸 필터 크기 (비트, 2의 거듭제곱, 레코드당 16비트)
+#define JOURNAL_PATH_NONE 0                   // 경로 없음 (0은 헤더 위치라 문자열 ID가 될 수 없음)
+
+// 세 파일 공통 헤더
+typedef struct {
+    uint32_t magic;                   // 파일 종류
+    uint32_t version;                 // JOURNAL_VERSION
+    uint32_t entrySize;               // 레코드/색인 블록 크기 (문자열 표는 0)
+    uint32_t reserved;
+} JournalHeader;
+
+// 이벤트 레코드 (32바이트)
+typedef struct {
+    uint64_t sequence;                // 단조 증가 순서 번호
+    int64_t timeNs;                   // 이벤트 발생 시각 (CLOCK_REALTIME, 나노초)
+    uint32_t mask;                    // inotify 이벤트 마스크
+    uint32_t count;                   // 병합된 원본 이벤트 수
+    uint32_t pathId;                  // 경로 문자열 ID
+    uint32_t oldPathId;               // 이름 변경 전 경로 문자열 ID (없으면 JOURNAL_PATH_NONE)
+} JournalRecord;
+
+// 문자열 표 항목: 길이 뒤에 NUL로 끝나는 경로가 오고 4바이트 단위로 맞춤
+// 문자열 ID는 항목의 파일 위치 / 4
+typedef struct {
+    uint32_t length;                  // NUL을 뺀 경로 길이
+    char text[];
+} JournalString;
+
+// 희소 색인 블록: 레코드 묶음의 시간 범위와 경로 블룸 필터
+typedef struct {
+    uint64_t firstSequence;           // 블록의 첫 레코드 번호
+    int64_t minTimeNs;                // 블록 안에서 가장 이른 시각
+    int64_t maxTimeNs;                // 블록 안에서 가장 늦은 시각
+    uint64_t pathBloom[JOURNAL_BLOOM_BITS / 64]; // 블록에 나오는 경로 (이전 경로 포함)
+} JournalIndexBlock;
+
+// 경로 해시 (FNV-1a 64비트)
+static inline uint64_t journal_path_hash(const char* path) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const unsigned char* c = (const unsigned char*)path; *c; ++c) {
+        hash ^= *c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// 블룸 필터에 경로 해시 추가 (비트 3개)
+static inline void journal_bloom_add(uint64_t* bloom, uint64_t hash) {
+    for (int i = 0; i < 3; ++i) {
+        uint32_t bit = (uint32_t)(hash >> (i * 21)) & (JOURNAL_BLOOM_BITS - 1);
+        bloom[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+// 블룸 필터에 경로 해시가 있을 수 있는지 확인
+static inline int journal_bloom_may_contain(const uint64_t* bloom, uint64_t hash) {
+    for (int i = 0; i < 3; ++i) {
+        uint32_t bit = (uint32_t)(hash >> (i * 21)) & (JOURNAL_BLOOM_BITS - 1);
+        if (!(bloom[bit / 64] & (1ull << (bit % 64)))) return 0;
+    }
+    return 1;
+}
+
+#endif
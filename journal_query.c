@@ -0,0 +1,198 @@
+#define _GNU_SOURCE // strptime
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "journal.h"
+
+#define EXT_SUCCESS 0                // 성공 코드
+#define EXT_ERR_TOO_FEW_ARGS 1       // 인자 부족 오류 코드
+#define EXT_ERR_OPEN_JOURNAL 2       // 저널 파일 열기 실패 오류 코드
+#define EXT_ERR_BAD_ARGUMENT 3       // 잘못된 인자 오류 코드
+
+// mmap으로 연 저널 파일
+typedef struct {
+    const char* data;                 // 파일 내용 (헤더 포함)
+    size_t size;                      // 파일 크기
+} MappedFile;
+
+// 검색 조건
+typedef struct {
+    int64_t sinceNs;                  // 이 시각 이후 (포함)
+    int64_t untilNs;                  // 이 시각 이전 (포함)
+    const char* path;                 // 정확히 일치해야 하는 경로 (NULL이면 전체)
+    uint64_t pathHash;                // path의 해시
+} JournalQuery;
+
+MappedFile records;                   // 레코드 파일
+MappedFile strings;                   // 문자열 표 파일
+MappedFile indexBlocks;               // 색인 파일
+
+// 파일을 읽기 전용으로 mmap하고 헤더 확인 (실패 시 -1)
+int map_journal_file(const char* path, uint32_t magic, uint32_t entrySize, MappedFile* file) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == -1 || fileStat.st_size < (off_t)sizeof(JournalHeader)) {
+        fprintf(stderr, "Invalid journal file %s\n", path);
+        close(fd);
+        return -1;
+    }
+    file->size = (size_t)fileStat.st_size;
+    file->data = mmap(NULL, file->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (file->data == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+    madvise((void*)file->data, file->size, MADV_RANDOM); // 색인으로 필요한 블록만 읽음
+
+    const JournalHeader* header = (const JournalHeader*)file->data;
+    if (header->magic != magic || header->version != JOURNAL_VERSION || header->entrySize != entrySize) {
+        fprintf(stderr, "Incompatible journal file %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+// 문자열 ID의 경로 (파일 범위를 벗어나면 NULL)
+const char* journal_string(uint32_t id) {
+    size_t offset = (size_t)id * 4;
+    if (id == JOURNAL_PATH_NONE || offset + sizeof(JournalString) > strings.size) return NULL;
+    const JournalString* entry = (const JournalString*)(strings.data + offset);
+    if (offset + sizeof(JournalString) + entry->length >= strings.size) return NULL;
+    return entry->text;
+}
+
+// 이벤트 종류를 문자열로 변환 (file_monitor와 같은 표기)
+const char* event_kind_name(uint32_t mask) {
+    if (mask & IN_Q_OVERFLOW) return "queue overflow";
+    if ((mask & IN_MOVED_FROM) && (mask & IN_MOVED_TO)) return "renamed";
+    if (mask & IN_MOVED_FROM) return "moved out";
+    if (mask & IN_MOVED_TO) return "moved in";
+    if ((mask & IN_CREATE) && (mask & IN_DELETE)) return "created and deleted";
+    if (mask & IN_CREATE) return "created";
+    if (mask & IN_DELETE) return "deleted";
+    if (mask & IN_MODIFY) return "modified";
+    if (mask & IN_MOVE_SELF) return "moved";
+    return "changed";
+}
+
+// 레코드가 검색 조건에 맞으면 출력 (출력했으면 true)
+bool print_if_matches(const JournalRecord* record, const JournalQuery* query) {
+    if (record->timeNs < query->sinceNs || record->timeNs > query->untilNs) return false;
+
+    const char* path = journal_string(record->pathId);
+    const char* oldPath = journal_string(record->oldPathId);
+    if (query->path && !(path && strcmp(path, query->path) == 0) && !(oldPath && strcmp(oldPath, query->path) == 0)) {
+        return false;
+    }
+
+    char eventTime[64];
+    time_t seconds = (time_t)(record->timeNs / 1000000000);
+    struct tm localTime;
+    strftime(eventTime, sizeof(eventTime), "%Y-%m-%d %H:%M:%S", localtime_r(&seconds, &localTime));
+
+    printf("#%llu [%s.%09lld] File %s: %s", (unsigned long long)record->sequence, eventTime,
+           (long long)(record->timeNs % 1000000000), path ? path : "?", event_kind_name(record->mask));
+    if (oldPath) printf(" from %s", oldPath);
+    if (record->count > 1) printf(" (%u events)", record->count);
+    putchar('\n');
+    return true;
+}
+
+// 시각 인자 해석: 유닉스 초 또는 "YYYY-MM-DD HH:MM:SS" (지역 시간)
+int parse_time(const char* text, int64_t* timeNs) {
+    char* end;
+    long long seconds = strtoll(text, &end, 10);
+    if (*end == '\0') {
+        *timeNs = seconds * 1000000000;
+        return 0;
+    }
+
+    struct tm localTime;
+    memset(&localTime, 0, sizeof(localTime));
+    end = strptime(text, "%Y-%m-%d %H:%M:%S", &localTime);
+    if (!end || *end != '\0') {
+        end = strptime(text, "%Y-%m-%d", &localTime);
+        if (!end || *end != '\0') return -1;
+    }
+    localTime.tm_isdst = -1;
+    *timeNs = (int64_t)mktime(&localTime) * 1000000000;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "USAGE: journal_query JOURNAL_FILE [--since TIME] [--until TIME] [--path PATH]\n");
+        exit(EXT_ERR_TOO_FEW_ARGS);
+    }
+
+    JournalQuery query = { INT64_MIN, INT64_MAX, NULL, 0 };
+    for (int i = 2; i < argc; ++i) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Missing value for %s\n", argv[i]);
+            exit(EXT_ERR_BAD_ARGUMENT);
+        }
+        if (strcmp(argv[i], "--since") == 0 && parse_time(argv[i + 1], &query.sinceNs) == 0) i++;
+        else if (strcmp(argv[i], "--until") == 0 && parse_time(argv[i + 1], &query.untilNs) == 0) i++;
+        else if (strcmp(argv[i], "--path") == 0) query.path = argv[++i];
+        else {
+            fprintf(stderr, "Invalid argument %s %s\n", argv[i], argv[i + 1]);
+            exit(EXT_ERR_BAD_ARGUMENT);
+        }
+    }
+    if (query.path) query.pathHash = journal_path_hash(query.path);
+
+    char stringPath[PATH_MAX];
+    char indexPath[PATH_MAX];
+    snprintf(stringPath, sizeof(stringPath), "%s.strings", argv[1]);
+    snprintf(indexPath, sizeof(indexPath), "%s.index", argv[1]);
+    if (map_journal_file(argv[1], JOURNAL_RECORD_MAGIC, sizeof(JournalRecord), &records) == -1 ||
+        map_journal_file(stringPath, JOURNAL_STRING_MAGIC, 0, &strings) == -1 ||
+        map_journal_file(indexPath, JOURNAL_INDEX_MAGIC, sizeof(JournalIndexBlock), &indexBlocks) == -1) {
+        exit(EXT_ERR_OPEN_JOURNAL);
+    }
+
+    const JournalRecord* recordArray = (const JournalRecord*)(records.data + sizeof(JournalHeader));
+    const JournalIndexBlock* blockArray = (const JournalIndexBlock*)(indexBlocks.data + sizeof(JournalHeader));
+    uint64_t recordCount = (records.size - sizeof(JournalHeader)) / sizeof(JournalRecord);
+    uint64_t blockCount = (indexBlocks.size - sizeof(JournalHeader)) / sizeof(JournalIndexBlock);
+    if (blockCount > recordCount / JOURNAL_BLOCK_RECORDS) blockCount = recordCount / JOURNAL_BLOCK_RECORDS;
+
+    // 색인 블록의 시간 범위와 블룸 필터로 건너뛸 수 없는 블록만 읽음
+    uint64_t matched = 0;
+    uint64_t scannedBlocks = 0;
+    for (uint64_t block = 0; block < blockCount; ++block) {
+        const JournalIndexBlock* index = &blockArray[block];
+        if (index->maxTimeNs < query.sinceNs || index->minTimeNs > query.untilNs) continue;
+        if (query.path && !journal_bloom_may_contain(index->pathBloom, query.pathHash)) continue;
+
+        scannedBlocks++;
+        for (uint64_t i = block * JOURNAL_BLOCK_RECORDS; i < (block + 1) * JOURNAL_BLOCK_RECORDS; ++i) {
+            if (print_if_matches(&recordArray[i], &query)) matched++;
+        }
+    }
+
+    // 아직 색인되지 않은 마지막 레코드들은 모두 확인
+    for (uint64_t i = blockCount * JOURNAL_BLOCK_RECORDS; i < recordCount; ++i) {
+        if (print_if_matches(&recordArray[i], &query)) matched++;
+    }
+
+    fprintf(stderr, "%llu matches, %llu of %llu index blocks scanned, %llu records\n",
+            (unsigned long long)matched, (unsigned long long)scannedBlocks,
+            (unsigned long long)blockCount, (unsigned long long)recordCount);
+    return EXT_SUCCESS;
+}